@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+// Общие части программ замеров: чтение входа целиком и лучшее время из нескольких запусков
+namespace bench {
+
+    inline std::string ReadFile(const std::string& path) {
+        std::ifstream input(path, std::ios::binary);
+        if (!input) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+
+    // Время одного запуска action в секундах
+    template <typename Action>
+    double Measure(Action&& action) {
+        const auto start = std::chrono::steady_clock::now();
+        action();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Минимальное время action в секундах из repeats запусков
+    template <typename Action>
+    double BestOf(int repeats, Action&& action) {
+        double best = 0.0;
+        for (int i = 0; i < repeats; ++i) {
+            const double seconds = Measure(action);
+            best = i == 0 ? seconds : std::min(best, seconds);
+        }
+        return best;
+    }
+
+    inline double MegabytesPerSecond(size_t bytes, double seconds) {
+        return static_cast<double>(bytes) / (1 << 20) / seconds;
+    }
+}
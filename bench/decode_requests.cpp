@@ -0,0 +1,144 @@
+// Стоимость разбора одной записи base_requests и stat_requests, нс на запись, лучшее из нескольких запусков:
+//   schema - по таблицам полей: ReadBaseRequest прямо из потока, DecodeStatRequest из дерева запроса;
+//   dom    - общим путём: дерево каждой записи и поиск полей в словаре, как до разбора по схеме.
+// Для base_requests в замер входит чтение токенов из потока, для stat_requests - только разбор словарей.
+// Запуск: decode_requests <файл> [повторы]
+#include "bench.h"
+#include "json_reader.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+using namespace std::literals;
+
+namespace {
+    using Token = json::StreamReader::Token;
+
+    // Поля, которые загрузчик берёт из записи; сумма нужна, чтобы компилятор не выбросил разбор
+    size_t DecodeBaseSchema(json::StreamReader& reader, Token token, BaseRequest& request) {
+        ReadBaseRequest(reader, token, request);
+        return request.name.size() + request.stops.size() + request.road_distances.size()
+            + static_cast<size_t>(request.coordinates.lat != 0.0);
+    }
+
+    size_t DecodeBaseDom(json::StreamReader& reader, Token token) {
+        const Node node = reader.ReadNode(token);
+        const Dict& dict = node.AsDict();
+        const std::string_view type = dict.at("type"s).AsString();
+        size_t result = dict.at("name"s).AsString().size();
+        if (type == "Stop"sv) {
+            result += static_cast<size_t>(dict.at("latitude"s).AsDouble() + dict.at("longitude"s).AsDouble() != 0.0);
+            if (const auto itr = dict.find("road_distances"s); itr != dict.end()) {
+                for (const auto& [stop, distance] : itr->second.AsDict()) {
+                    result += stop.size() + static_cast<size_t>(distance.AsInt());
+                }
+            }
+        }
+        else if (type == "Bus"sv) {
+            for (const Node& stop : dict.at("stops"s).AsArray()) {
+                result += stop.AsString().size();
+            }
+            result += dict.at("is_roundtrip"s).AsBool();
+        }
+        return result;
+    }
+
+    size_t DecodeStatSchema(const Dict& dict) {
+        const StatRequest request = DecodeStatRequest(dict);
+        return static_cast<size_t>(request.id) + request.type.size() + request.params.size()
+            + (request.name ? request.name->size() : 0) + (request.from ? request.from->size() : 0);
+    }
+
+    // Поля вне общей схемы запроса раньше передавались обработчику копией всего словаря
+    size_t DecodeStatDom(const Dict& dict) {
+        const std::string_view type = dict.at("type"s).AsString();
+        size_t result = static_cast<size_t>(dict.at("id"s).AsInt()) + type.size();
+        if (type == "Bus"sv || type == "Stop"sv) {
+            result += dict.at("name"s).AsString().size();
+        }
+        else {
+            if (const auto itr = dict.find("from"s); itr != dict.end()) {
+                result += itr->second.AsString().size() + dict.at("to"s).AsString().size();
+            }
+            const Dict params = dict;
+            result += params.size();
+        }
+        return result;
+    }
+
+    // Время чтения всех записей base_requests; остальные секции пропускаются без замера
+    template <typename Decode>
+    double TimeBaseRequests(const std::string& text, size_t& count, size_t& sink, Decode&& decode) {
+        std::istringstream input(text);
+        json::Arena arena;
+        json::StreamReader reader(input, 1 << 16, &arena);
+        double seconds = 0.0;
+        count = 0;
+        reader.Next();
+        for (Token token = reader.Next(); token != Token::END_DICT; token = reader.Next()) {
+            if (reader.GetKey() != "base_requests"sv) {
+                reader.ReadNode(reader.Next());
+                continue;
+            }
+            reader.Next();
+            seconds = bench::Measure([&] {
+                for (Token item = reader.Next(); item != Token::END_ARRAY; item = reader.Next()) {
+                    sink += decode(reader, item);
+                    ++count;
+                }
+            });
+        }
+        return seconds;
+    }
+
+    double NanosecondsPerRecord(double seconds, size_t count) {
+        return count == 0 ? 0.0 : seconds * 1e9 / static_cast<double>(count);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <file.json> [repeats]\n", argv[0]);
+        return 1;
+    }
+    const std::string text = bench::ReadFile(argv[1]);
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+    size_t sink = 0;
+
+    size_t base_count = 0;
+    double base_schema = 0.0;
+    double base_dom = 0.0;
+    BaseRequest request;
+    for (int i = 0; i < repeats; ++i) {
+        const double schema = TimeBaseRequests(text, base_count, sink,
+            [&request](json::StreamReader& reader, Token token) { return DecodeBaseSchema(reader, token, request); });
+        const double dom = TimeBaseRequests(text, base_count, sink, DecodeBaseDom);
+        base_schema = i == 0 ? schema : std::min(base_schema, schema);
+        base_dom = i == 0 ? dom : std::min(base_dom, dom);
+    }
+    if (base_count > 0) {
+        std::printf("base_requests: %zu records, schema %.0f ns, dom %.0f ns\n", base_count,
+            NanosecondsPerRecord(base_schema, base_count), NanosecondsPerRecord(base_dom, base_count));
+    }
+
+    const json::Document doc = json::Load(std::string_view(text));
+    const Dict& root = doc.GetRoot().AsDict();
+    if (const auto itr = root.find("stat_requests"s); itr != root.end()) {
+        const Array& requests = itr->second.AsArray();
+        const double schema = bench::BestOf(repeats, [&] {
+            for (const Node& item : requests) {
+                sink += DecodeStatSchema(item.AsDict());
+            }
+        });
+        const double dom = bench::BestOf(repeats, [&] {
+            for (const Node& item : requests) {
+                sink += DecodeStatDom(item.AsDict());
+            }
+        });
+        std::printf("stat_requests: %zu records, schema %.0f ns, dom %.0f ns\n", requests.size(),
+            NanosecondsPerRecord(schema, requests.size()), NanosecondsPerRecord(dom, requests.size()));
+    }
+    // Нулевая сумма - во входе нет ни одной записи
+    return sink > 0 ? 0 : 1;
+}
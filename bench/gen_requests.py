@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Входы для замеров: случайный справочник с base_requests.
+
+  gen_requests.py catalogue big.json   - 200k остановок, 10k автобусов по 20 остановок, JSON с отступами
+  gen_requests.py mix mix.json         - стандартная смесь: первые 2k остановок того же справочника,
+                                         60k stat_requests: 45% Bus, 45% Stop, 10% Route
+  gen_requests.py msgpack mix.json mix.mp - тот же документ в MessagePack
+"""
+import argparse
+import json
+import random
+import struct
+
+
+def make_catalogue(stop_count, bus_count, bus_length, seed):
+    rnd = random.Random(seed)
+    stops = [{
+        'type': 'Stop',
+        'name': 'Stop %d' % i,
+        'latitude': 55 + rnd.random(),
+        'longitude': 37 + rnd.random(),
+        'road_distances': {'Stop %d' % rnd.randrange(stop_count): rnd.randrange(100, 3000) for _ in range(3)},
+    } for i in range(stop_count)]
+    buses = [{
+        'type': 'Bus',
+        'name': 'Bus %d' % i,
+        'stops': ['Stop %d' % rnd.randrange(stop_count) for _ in range(bus_length)],
+        'is_roundtrip': False,
+    } for i in range(bus_count)]
+    return stops, buses
+
+
+def catalogue(args):
+    stops, buses = make_catalogue(args.stops, args.buses, args.bus_length, args.seed)
+    with open(args.output, 'w') as output:
+        json.dump({'base_requests': stops + buses}, output, indent=4)
+
+
+RENDER_SETTINGS = {
+    'bus_label_font_size': 20, 'bus_label_offset': [7, 15],
+    'color_palette': ['green', [255, 160, 0], 'red', [1, 2, 3, 0.5]],
+    'height': 200, 'line_width': 14, 'padding': 30,
+    'stop_label_font_size': 20, 'stop_label_offset': [7, -3], 'stop_radius': 5,
+    'underlayer_color': [255, 255, 255, 0.85], 'underlayer_width': 3, 'width': 200,
+}
+ROUTING_SETTINGS = {'bus_velocity': 30, 'bus_wait_time': 2}
+
+
+def mix(args):
+    stops, buses = make_catalogue(200000, 10000, 20, 1)
+    # Маршруты урезаются до оставленных остановок, автобусы короче двух остановок отбрасываются
+    stops = stops[:args.stops]
+    keep = {stop['name'] for stop in stops}
+    for stop in stops:
+        stop['road_distances'] = {name: distance for name, distance in stop['road_distances'].items() if name in keep}
+    kept_buses = []
+    for bus in buses:
+        bus['stops'] = [name for name in bus['stops'] if name in keep]
+        if len(bus['stops']) >= 2:
+            kept_buses.append(bus)
+
+    rnd = random.Random(args.seed)
+    stop_names = [stop['name'] for stop in stops]
+    bus_names = [bus['name'] for bus in kept_buses]
+    requests = []
+    for i in range(args.requests):
+        x = rnd.random()
+        if x < 0.45:
+            requests.append({'id': i, 'type': 'Bus', 'name': rnd.choice(bus_names)})
+        elif x < 0.9:
+            requests.append({'id': i, 'type': 'Stop', 'name': rnd.choice(stop_names)})
+        else:
+            requests.append({'id': i, 'type': 'Route', 'from': rnd.choice(stop_names), 'to': rnd.choice(stop_names)})
+
+    with open(args.output, 'w') as output:
+        json.dump({
+            'base_requests': stops + kept_buses,
+            'stat_requests': requests,
+            'render_settings': RENDER_SETTINGS,
+            'routing_settings': ROUTING_SETTINGS,
+        }, output, indent=4)
+
+
+def write_msgpack(value, out):
+    if value is None:
+        out.append(0xc0)
+    elif value is True or value is False:
+        out.append(0xc3 if value else 0xc2)
+    elif isinstance(value, int):
+        if 0 <= value <= 127:
+            out.append(value)
+        elif -32 <= value < 0:
+            out.append(value & 0xff)
+        elif -2**31 <= value < 2**31:
+            out += b'\xd2' + struct.pack('>i', value)
+        else:
+            out += b'\xd3' + struct.pack('>q', value)
+    elif isinstance(value, float):
+        out += b'\xcb' + struct.pack('>d', value)
+    elif isinstance(value, str):
+        data = value.encode()
+        write_header(len(data), out, 0xa0, 31, b'\xd9', b'\xda', b'\xdb')
+        out += data
+    elif isinstance(value, list):
+        write_header(len(value), out, 0x90, 15, None, b'\xdc', b'\xdd')
+        for item in value:
+            write_msgpack(item, out)
+    else:
+        write_header(len(value), out, 0x80, 15, None, b'\xde', b'\xdf')
+        for key, item in value.items():
+            write_msgpack(key, out)
+            write_msgpack(item, out)
+
+
+def write_header(size, out, fix, fix_max, tag8, tag16, tag32):
+    if size <= fix_max:
+        out.append(fix | size)
+    elif tag8 is not None and size <= 0xff:
+        out += tag8 + bytes([size])
+    elif size <= 0xffff:
+        out += tag16 + struct.pack('>H', size)
+    else:
+        out += tag32 + struct.pack('>I', size)
+
+
+def msgpack(args):
+    with open(args.input) as input:
+        document = json.load(input)
+    out = bytearray()
+    write_msgpack(document, out)
+    with open(args.output, 'wb') as output:
+        output.write(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    command = commands.add_parser('catalogue', help='base_requests only')
+    command.add_argument('output')
+    command.add_argument('--stops', type=int, default=200000)
+    command.add_argument('--buses', type=int, default=10000)
+    command.add_argument('--bus-length', type=int, default=20)
+    command.add_argument('--seed', type=int, default=1)
+    command.set_defaults(run=catalogue)
+
+    command = commands.add_parser('mix', help='standard request mix')
+    command.add_argument('output')
+    command.add_argument('--stops', type=int, default=2000)
+    command.add_argument('--requests', type=int, default=60000)
+    command.add_argument('--seed', type=int, default=5)
+    command.set_defaults(run=mix)
+
+    command = commands.add_parser('msgpack', help='convert a JSON document to MessagePack')
+    command.add_argument('input')
+    command.add_argument('output')
+    command.set_defaults(run=msgpack)
+
+    args = parser.parse_args()
+    args.run(args)
+
+
+if __name__ == '__main__':
+    main()
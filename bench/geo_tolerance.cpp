@@ -0,0 +1,70 @@
+// Проверка geo::BATCH_DISTANCE_TOLERANCE: пакетный расчёт по единичным векторам
+// сравнивается с ComputeDistance по координатам на случайных парах точек: близких (от сантиметров
+// до тысяч километров) и почти противоположных. Допуск обещан для пар, разнесённых хотя бы на метр
+// и не ближе метра к антиподу, остальные пары пропускаются. Код возврата 1, если расхождение больше допуска
+#define _USE_MATH_DEFINES
+#include "geo.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std::literals;
+
+int main() {
+    std::mt19937_64 random(2024);
+    std::uniform_real_distribution<double> lat(-89.0, 89.0);
+    std::uniform_real_distribution<double> lng(-180.0, 180.0);
+    // Смещение второй точки пары: от 1e-7 до 1e2 градусов
+    std::uniform_real_distribution<double> log_offset(-7.0, 2.0);
+
+    constexpr size_t POINT_COUNT = 1'000'000;
+    geo::UnitVectors points;
+    points.Reserve(POINT_COUNT);
+    std::vector<geo::Coordinates> coordinates;
+    coordinates.reserve(POINT_COUNT);
+    for (size_t i = 0; i < POINT_COUNT; ++i) {
+        geo::Coordinates point{ lat(random), lng(random) };
+        if (i % 2 == 1) {
+            const geo::Coordinates& prev = coordinates.back();
+            const double offset = std::pow(10.0, log_offset(random));
+            point = i % 4 == 1
+                ? geo::Coordinates{ std::clamp(prev.lat + offset, -90.0, 90.0), prev.lng + offset }
+                : geo::Coordinates{ -prev.lat + offset, prev.lng + 180.0 };
+        }
+        coordinates.push_back(point);
+        points.Add(point);
+    }
+
+    std::vector<size_t> ids(POINT_COUNT);
+    for (size_t i = 0; i < POINT_COUNT; ++i) {
+        ids[i] = i;
+    }
+    std::vector<double> batch(POINT_COUNT - 1);
+    geo::ComputeRouteDistances(points, ids.data(), ids.size(), batch.data());
+
+    const double MAX_DISTANCE = M_PI * geo::EARTH_RADIUS;
+    double max_error = 0.0;
+    size_t checked = 0;
+    for (size_t i = 0; i + 1 < POINT_COUNT; ++i) {
+        const double expected = geo::ComputeDistance(coordinates[i], coordinates[i + 1]);
+        // Без ограничения аргумента acos скалярная формула на совпадающих точках даёт NaN
+        if (std::isnan(expected) || expected < 1.0 || expected > MAX_DISTANCE - 1.0) {
+            continue;
+        }
+        max_error = std::max({ max_error, std::abs(batch[i] - expected),
+            std::abs(geo::ComputeDistance(points, i, i + 1) - expected) });
+        ++checked;
+    }
+
+    std::cout << "pairs: "sv << checked << ", max error: "sv << max_error
+        << " m, tolerance: "sv << geo::BATCH_DISTANCE_TOLERANCE << " m"sv << std::endl;
+    if (max_error > geo::BATCH_DISTANCE_TOLERANCE) {
+        std::cout << "FAILED"sv << std::endl;
+        return 1;
+    }
+    std::cout << "OK"sv << std::endl;
+    return 0;
+}
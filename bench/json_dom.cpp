@@ -0,0 +1,78 @@
+// Стоимость операций над деревом JSON-документа, лучшее из нескольких запусков:
+//   parse  - json::Load из буфера;
+//   lookup - поиск полей в каждом объекте base_requests, как при загрузке справочника;
+//   free   - уничтожение разобранного документа;
+//   build  - 300k словарей ответа через json::Builder, как ответы на запросы Bus;
+//   print  - вывод разобранного документа в строку.
+// Запуск: json_dom <файл с base_requests> [повторы]
+#include "bench.h"
+#include "json.h"
+#include "json_builder.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <sstream>
+
+using namespace std::literals;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <file.json> [repeats]\n", argv[0]);
+        return 1;
+    }
+    const std::string input = bench::ReadFile(argv[1]);
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    double parse = 0.0;
+    double free = 0.0;
+    for (int i = 0; i < repeats; ++i) {
+        std::optional<json::Document> parsed;
+        const double parse_time = bench::Measure([&] { parsed.emplace(json::Load(std::string_view(input))); });
+        const double free_time = bench::Measure([&] { parsed.reset(); });
+        parse = i == 0 ? parse_time : std::min(parse, parse_time);
+        free = i == 0 ? free_time : std::min(free, free_time);
+    }
+    const json::Document doc = json::Load(std::string_view(input));
+
+    // Результат поиска накапливается, чтобы компилятор не выбросил цикл
+    size_t found = 0;
+    const json::Array& requests = doc.GetRoot().AsDict().at("base_requests"s).AsArray();
+    const double lookup = bench::BestOf(repeats, [&] {
+        for (const json::Node& request : requests) {
+            const json::Dict& dict = request.AsDict();
+            found += dict.at("type"s).AsString().size();
+            found += dict.at("name"s).AsString().size();
+            found += dict.count("latitude"s) + dict.count("stops"s) + dict.count("is_roundtrip"s);
+            if (const auto itr = dict.find("road_distances"s); itr != dict.end()) {
+                found += itr->second.AsDict().size();
+            }
+        }
+    });
+
+    const double build = bench::BestOf(repeats, [&] {
+        json::Builder builder;
+        builder.StartArray();
+        for (int i = 0; i < 300000; ++i) {
+            builder.StartDict()
+                .Key("curvature"s).Value(1.5)
+                .Key("request_id"s).Value(i)
+                .Key("route_length"s).Value(1000 + i)
+                .Key("stop_count"s).Value(5)
+                .Key("unique_stop_count"s).Value(3)
+                .EndDict();
+        }
+        found += builder.EndArray().Build().AsArray().size();
+    });
+
+    const double print = bench::BestOf(repeats, [&] {
+        std::ostringstream output;
+        json::Print(doc, output);
+        found += output.str().size();
+    });
+
+    std::printf("parse: %.3f s\nlookup: %.3f s\nfree: %.3f s\nbuild: %.3f s\nprint: %.3f s\n",
+        parse, lookup, free, build, print);
+    // Пустой результат поиска - вход без base_requests
+    return found > 0 ? 0 : 1;
+}
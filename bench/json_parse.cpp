@@ -0,0 +1,31 @@
+// Пропускная способность разбора JSON: json::Load из буфера в памяти и из потока, лучшее из нескольких запусков.
+// Запуск: json_parse <файл> [повторы]
+// С -DSTREAM_ONLY собирается и с деревом до появления Load(std::string_view), для сравнения версий
+#include "bench.h"
+#include "json.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <file.json> [repeats]\n", argv[0]);
+        return 1;
+    }
+    const std::string input = bench::ReadFile(argv[1]);
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+
+#ifndef STREAM_ONLY
+    const double buffer = bench::BestOf(repeats, [&] {
+        json::Document doc = json::Load(std::string_view(input));
+    });
+    std::printf("buffer: %.3f s, %.1f MB/s\n", buffer, bench::MegabytesPerSecond(input.size(), buffer));
+#endif
+    const double stream = bench::BestOf(repeats, [&] {
+        std::istringstream stream(input);
+        json::Document doc = json::Load(stream);
+    });
+    std::printf("stream: %.3f s, %.1f MB/s\n", stream, bench::MegabytesPerSecond(input.size(), stream));
+    return 0;
+}
@@ -0,0 +1,39 @@
+#!/usr/bin/env python3
+"""Время работы справочника на одном и том же документе в JSON и в MessagePack.
+
+  time_formats.py <программа> <документ.json> <документ.mp> [повторы]
+
+Программа запускается целиком (загрузка, построение маршрутизатора, ответы); для каждого
+формата выводится лучшее время из нескольких запусков и размеры входа и ответа.
+"""
+import os
+import subprocess
+import sys
+import time
+
+
+def run(program, options, path, repeats):
+    best = None
+    output = b''
+    for _ in range(repeats):
+        with open(path, 'rb') as input:
+            start = time.perf_counter()
+            output = subprocess.run([program] + options, stdin=input, stdout=subprocess.PIPE, check=True).stdout
+            seconds = time.perf_counter() - start
+        best = seconds if best is None else min(best, seconds)
+    return best, len(output)
+
+
+def main():
+    if len(sys.argv) < 4:
+        sys.exit(__doc__)
+    program, json_path, msgpack_path = sys.argv[1:4]
+    repeats = int(sys.argv[4]) if len(sys.argv) > 4 else 5
+    for name, options, path in (('json', [], json_path), ('msgpack', ['--format', 'msgpack'], msgpack_path)):
+        seconds, output_size = run(program, options, path, repeats)
+        print('%-8s %.3f s, input %.1f MB, output %.1f MB'
+              % (name, seconds, os.path.getsize(path) / 2**20, output_size / 2**20))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,424 @@
+#include "catalogue_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace transportcatalogue {
+
+	using namespace std::literals;
+
+	namespace {
+		constexpr size_t SECTION_ALIGN = 8;
+
+		class ImageBuilder {
+		public:
+			ImageBuilder() {
+				buffer_.resize(AlignUp(sizeof(image::Header)));
+			}
+
+			template <typename T>
+			image::Section Append(const std::vector<T>& items) {
+				return AppendBytes(items.data(), items.size() * sizeof(T));
+			}
+
+			image::Section AppendBytes(const void* data, size_t size) {
+				image::Section section{ buffer_.size(), size };
+				buffer_.append(static_cast<const char*>(data), size);
+				buffer_.resize(AlignUp(buffer_.size()));
+				return section;
+			}
+
+			std::string& Finish(image::Header header) {
+				header.file_size = buffer_.size();
+				std::memcpy(buffer_.data(), &header, sizeof(header));
+				return buffer_;
+			}
+
+		private:
+			static size_t AlignUp(size_t size) {
+				return (size + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN;
+			}
+
+			std::string buffer_;
+		};
+
+		class StringPool {
+		public:
+			image::StringRef Add(std::string_view str) {
+				if (pool_.size() + str.size() > UINT32_MAX) {
+					throw std::length_error("Catalogue image string pool overflow"s);
+				}
+				image::StringRef ref{ static_cast<uint32_t>(pool_.size()), static_cast<uint32_t>(str.size()) };
+				pool_.append(str);
+				return ref;
+			}
+
+			const std::string& GetData() const {
+				return pool_;
+			}
+
+		private:
+			std::string pool_;
+		};
+	}
+
+	void WriteCatalogueImage(const TransportCatalogue& tc, std::ostream& output) {
+		vector<StopPtr> stops;
+		stops.reserve(tc.GetStopsInfo().size());
+		for (const auto& [name, stop] : tc.GetStopsInfo()) {
+			stops.push_back(stop);
+		}
+		std::sort(stops.begin(), stops.end(), [](StopPtr lhs, StopPtr rhs) { return lhs->id < rhs->id; });
+
+		// Автобусы нумеруются в порядке имён, тогда списки автобусов по остановкам сразу упорядочены
+		vector<BusPtr> buses;
+		buses.reserve(tc.GetBusesInfo().size());
+		for (const auto& [name, bus] : tc.GetBusesInfo()) {
+			buses.push_back(bus);
+		}
+		std::sort(buses.begin(), buses.end(), [](BusPtr lhs, BusPtr rhs) { return lhs->name < rhs->name; });
+
+		unordered_map<StopPtr, uint32_t> stop_ids;
+		for (uint32_t id = 0; id < stops.size(); ++id) {
+			stop_ids[stops[id]] = id;
+		}
+
+		StringPool pool;
+		vector<image::StringRef> stop_names;
+		vector<double> stop_lat;
+		vector<double> stop_lng;
+		for (StopPtr stop : stops) {
+			stop_names.push_back(pool.Add(stop->name));
+			stop_lat.push_back(stop->coordinates.lat);
+			stop_lng.push_back(stop->coordinates.lng);
+		}
+
+		vector<image::StringRef> bus_names;
+		vector<uint8_t> bus_roundtrip;
+		vector<uint32_t> bus_stop_offsets{ 0 };
+		vector<uint32_t> bus_stops;
+		vector<vector<uint32_t>> buses_by_stop(stops.size());
+		for (uint32_t bus_id = 0; bus_id < buses.size(); ++bus_id) {
+			BusPtr bus = buses[bus_id];
+			bus_names.push_back(pool.Add(bus->name));
+			bus_roundtrip.push_back(bus->type ? 1 : 0);
+			for (StopPtr stop : bus->busstop_info) {
+				const uint32_t stop_id = stop_ids.at(stop);
+				bus_stops.push_back(stop_id);
+				vector<uint32_t>& stop_buses = buses_by_stop[stop_id];
+				if (stop_buses.empty() || stop_buses.back() != bus_id) {
+					stop_buses.push_back(bus_id);
+				}
+			}
+			bus_stop_offsets.push_back(static_cast<uint32_t>(bus_stops.size()));
+		}
+
+		vector<vector<image::DistanceEntry>> distance_rows(stops.size());
+		for (const auto& [stop_pair, distance] : tc.GetStopDistancesInfo()) {
+			const uint32_t from = stop_ids.at(stop_pair.first);
+			const uint32_t to = stop_ids.at(stop_pair.second);
+			distance_rows[from].push_back({ to, distance });
+		}
+
+		vector<uint32_t> distance_offsets{ 0 };
+		vector<image::DistanceEntry> distances;
+		vector<uint32_t> stop_bus_offsets{ 0 };
+		vector<uint32_t> stop_buses;
+		for (size_t id = 0; id < stops.size(); ++id) {
+			auto& row = distance_rows[id];
+			std::sort(row.begin(), row.end(), [](const auto& lhs, const auto& rhs) { return lhs.to < rhs.to; });
+			distances.insert(distances.end(), row.begin(), row.end());
+			distance_offsets.push_back(static_cast<uint32_t>(distances.size()));
+
+			stop_buses.insert(stop_buses.end(), buses_by_stop[id].begin(), buses_by_stop[id].end());
+			stop_bus_offsets.push_back(static_cast<uint32_t>(stop_buses.size()));
+		}
+
+		vector<uint32_t> stop_name_index(stops.size());
+		for (uint32_t id = 0; id < stops.size(); ++id) {
+			stop_name_index[id] = id;
+		}
+		std::sort(stop_name_index.begin(), stop_name_index.end(), [&stops](uint32_t lhs, uint32_t rhs) {
+			return stops[lhs]->name < stops[rhs]->name;
+			});
+		vector<uint32_t> bus_name_index(buses.size());
+		for (uint32_t id = 0; id < buses.size(); ++id) {
+			bus_name_index[id] = id;
+		}
+
+		image::Header header;
+		std::memcpy(header.magic, image::MAGIC, sizeof(header.magic));
+		header.stop_count = static_cast<uint32_t>(stops.size());
+		header.bus_count = static_cast<uint32_t>(buses.size());
+
+		ImageBuilder builder;
+		header.strings = builder.AppendBytes(pool.GetData().data(), pool.GetData().size());
+		header.stop_names = builder.Append(stop_names);
+		header.stop_lat = builder.Append(stop_lat);
+		header.stop_lng = builder.Append(stop_lng);
+		header.bus_names = builder.Append(bus_names);
+		header.bus_roundtrip = builder.Append(bus_roundtrip);
+		header.bus_stop_offsets = builder.Append(bus_stop_offsets);
+		header.bus_stops = builder.Append(bus_stops);
+		header.distance_offsets = builder.Append(distance_offsets);
+		header.distances = builder.Append(distances);
+		header.stop_bus_offsets = builder.Append(stop_bus_offsets);
+		header.stop_buses = builder.Append(stop_buses);
+		header.stop_name_index = builder.Append(stop_name_index);
+		header.bus_name_index = builder.Append(bus_name_index);
+
+		const std::string& data = builder.Finish(header);
+		output.write(data.data(), static_cast<std::streamsize>(data.size()));
+	}
+
+	void SaveCatalogueImage(const TransportCatalogue& tc, const std::string& path) {
+		std::ofstream output(path, std::ios::binary | std::ios::trunc);
+		if (!output) {
+			throw std::runtime_error("Can not open catalogue image for writing: "s + path);
+		}
+		WriteCatalogueImage(tc, output);
+		if (!output) {
+			throw std::runtime_error("Failed to write catalogue image: "s + path);
+		}
+	}
+
+	CatalogueImage::CatalogueImage(const std::string& path) {
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("Can not open catalogue image: "s + path);
+		}
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+			CloseHandle(file);
+			throw std::runtime_error("Invalid catalogue image: "s + path);
+		}
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping == nullptr) {
+			throw std::runtime_error("Can not map catalogue image: "s + path);
+		}
+		// Отображение остаётся действительным и после закрытия описателей
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (view == nullptr) {
+			throw std::runtime_error("Can not map catalogue image: "s + path);
+		}
+		data_ = static_cast<const char*>(view);
+		size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			throw std::runtime_error("Can not open catalogue image: "s + path);
+		}
+		struct stat file_stat;
+		if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+			close(fd);
+			throw std::runtime_error("Invalid catalogue image: "s + path);
+		}
+		void* view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (view == MAP_FAILED) {
+			throw std::runtime_error("Can not map catalogue image: "s + path);
+		}
+		data_ = static_cast<const char*>(view);
+		size_ = static_cast<size_t>(file_stat.st_size);
+#endif
+		header_ = reinterpret_cast<const image::Header*>(data_);
+		try {
+			Validate();
+		}
+		catch (...) {
+			Unmap();
+			throw;
+		}
+	}
+
+	CatalogueImage::~CatalogueImage() {
+		Unmap();
+	}
+
+	void CatalogueImage::Unmap() {
+		if (data_ == nullptr) {
+			return;
+		}
+#ifdef _WIN32
+		UnmapViewOfFile(data_);
+#else
+		munmap(const_cast<char*>(data_), size_);
+#endif
+		data_ = nullptr;
+		header_ = nullptr;
+	}
+
+	void CatalogueImage::Validate() const {
+		if (size_ < sizeof(image::Header)
+			|| std::memcmp(header_->magic, image::MAGIC, sizeof(image::MAGIC)) != 0
+			|| header_->version != image::FORMAT_VERSION
+			|| header_->endian_mark != image::ENDIAN_MARK
+			|| header_->file_size != size_) {
+			throw std::runtime_error("Invalid catalogue image header"s);
+		}
+
+		auto check_section = [this](const image::Section& section, uint64_t item_size, uint64_t expected_count) {
+			if (section.offset % SECTION_ALIGN != 0 || section.offset > size_ || section.size > size_ - section.offset
+				|| section.size % item_size != 0
+				|| (expected_count != UINT64_MAX && section.size / item_size != expected_count)) {
+				throw std::runtime_error("Invalid catalogue image section"s);
+			}
+		};
+		const uint64_t stops = header_->stop_count;
+		const uint64_t buses = header_->bus_count;
+		const image::Header& h = *header_;
+
+		check_section(h.strings, 1, UINT64_MAX);
+		check_section(h.stop_names, sizeof(image::StringRef), stops);
+		check_section(h.stop_lat, sizeof(double), stops);
+		check_section(h.stop_lng, sizeof(double), stops);
+		check_section(h.bus_names, sizeof(image::StringRef), buses);
+		check_section(h.bus_roundtrip, sizeof(uint8_t), buses);
+		check_section(h.bus_stop_offsets, sizeof(uint32_t), buses + 1);
+		check_section(h.bus_stops, sizeof(uint32_t), UINT64_MAX);
+		check_section(h.distance_offsets, sizeof(uint32_t), stops + 1);
+		check_section(h.distances, sizeof(image::DistanceEntry), UINT64_MAX);
+		check_section(h.stop_bus_offsets, sizeof(uint32_t), stops + 1);
+		check_section(h.stop_buses, sizeof(uint32_t), UINT64_MAX);
+		check_section(h.stop_name_index, sizeof(uint32_t), stops);
+		check_section(h.bus_name_index, sizeof(uint32_t), buses);
+
+		// Проверяются только границы CSR-массивов: полный обход данных сделал бы открытие O(n)
+		auto check_offsets = [this](const image::Section& offsets, const image::Section& items, uint64_t item_size) {
+			std::span<const uint32_t> values = GetSection<uint32_t>(offsets);
+			if (values.front() != 0 || values.back() != items.size / item_size) {
+				throw std::runtime_error("Invalid catalogue image offsets"s);
+			}
+		};
+		check_offsets(h.bus_stop_offsets, h.bus_stops, sizeof(uint32_t));
+		check_offsets(h.distance_offsets, h.distances, sizeof(image::DistanceEntry));
+		check_offsets(h.stop_bus_offsets, h.stop_buses, sizeof(uint32_t));
+	}
+
+	size_t CatalogueImage::GetCountStops() const {
+		return header_->stop_count;
+	}
+
+	size_t CatalogueImage::GetCountBuses() const {
+		return header_->bus_count;
+	}
+
+	std::string_view CatalogueImage::GetString(image::StringRef ref) const {
+		std::span<const char> pool = GetSection<char>(header_->strings);
+		if (static_cast<uint64_t>(ref.offset) + ref.length > pool.size()) {
+			throw std::out_of_range("Invalid string reference in catalogue image"s);
+		}
+		return { pool.data() + ref.offset, ref.length };
+	}
+
+	std::optional<CatalogueImage::StopId> CatalogueImage::FindStop(std::string_view name) const {
+		std::span<const uint32_t> index = GetSection<uint32_t>(header_->stop_name_index);
+		auto itr = std::lower_bound(index.begin(), index.end(), name, [this](uint32_t id, std::string_view value) {
+			return GetStopName(id) < value;
+			});
+		if (itr != index.end() && GetStopName(*itr) == name) {
+			return *itr;
+		}
+		return std::nullopt;
+	}
+
+	std::optional<CatalogueImage::BusId> CatalogueImage::FindBus(std::string_view name) const {
+		std::span<const uint32_t> index = GetSection<uint32_t>(header_->bus_name_index);
+		auto itr = std::lower_bound(index.begin(), index.end(), name, [this](uint32_t id, std::string_view value) {
+			return GetBusName(id) < value;
+			});
+		if (itr != index.end() && GetBusName(*itr) == name) {
+			return *itr;
+		}
+		return std::nullopt;
+	}
+
+	std::string_view CatalogueImage::GetStopName(StopId id) const {
+		return GetString(GetSection<image::StringRef>(header_->stop_names)[id]);
+	}
+
+	Coordinates CatalogueImage::GetStopCoordinates(StopId id) const {
+		return { GetSection<double>(header_->stop_lat)[id], GetSection<double>(header_->stop_lng)[id] };
+	}
+
+	std::string_view CatalogueImage::GetBusName(BusId id) const {
+		return GetString(GetSection<image::StringRef>(header_->bus_names)[id]);
+	}
+
+	bool CatalogueImage::IsRoundTrip(BusId id) const {
+		return GetSection<uint8_t>(header_->bus_roundtrip)[id] != 0;
+	}
+
+	std::span<const CatalogueImage::StopId> CatalogueImage::GetBusStops(BusId id) const {
+		std::span<const uint32_t> offsets = GetSection<uint32_t>(header_->bus_stop_offsets);
+		return GetSection<uint32_t>(header_->bus_stops).subspan(offsets[id], offsets[id + 1] - offsets[id]);
+	}
+
+	std::span<const CatalogueImage::BusId> CatalogueImage::GetBusesByStop(StopId id) const {
+		std::span<const uint32_t> offsets = GetSection<uint32_t>(header_->stop_bus_offsets);
+		return GetSection<uint32_t>(header_->stop_buses).subspan(offsets[id], offsets[id + 1] - offsets[id]);
+	}
+
+	int CatalogueImage::GetBusStopDistance(StopId from, StopId to) const {
+		std::span<const uint32_t> offsets = GetSection<uint32_t>(header_->distance_offsets);
+		std::span<const image::DistanceEntry> distances = GetSection<image::DistanceEntry>(header_->distances);
+
+		auto find = [&](StopId row_id, StopId target) -> std::optional<int> {
+			auto row = distances.subspan(offsets[row_id], offsets[row_id + 1] - offsets[row_id]);
+			auto itr = std::lower_bound(row.begin(), row.end(), target, [](const image::DistanceEntry& entry, StopId value) {
+				return entry.to < value;
+				});
+			if (itr != row.end() && itr->to == target) {
+				return itr->distance;
+			}
+			return std::nullopt;
+		};
+
+		if (auto distance = find(from, to)) {
+			return *distance;
+		}
+		return find(to, from).value_or(0);
+	}
+
+	std::optional<BusStatistic> CatalogueImage::GetRouteStatistic(std::string_view bus_name) const {
+		std::optional<BusId> bus = FindBus(bus_name);
+		if (!bus) {
+			return std::nullopt;
+		}
+		std::span<const StopId> stops = GetBusStops(*bus);
+		if (stops.empty()) {
+			return std::nullopt;
+		}
+
+		BusStatistic retinfo;
+		vector<StopId> uniq_stops(stops.begin(), stops.end());
+		std::sort(uniq_stops.begin(), uniq_stops.end());
+		retinfo.count_stopbus = stops.size();
+		retinfo.uniq_stopbus = std::unique(uniq_stops.begin(), uniq_stops.end()) - uniq_stops.begin();
+
+		for (size_t id = 0; id + 1 < stops.size(); ++id) {
+			retinfo.lenght += ComputeDistance(GetStopCoordinates(stops[id]), GetStopCoordinates(stops[id + 1]));
+			retinfo.distance += GetBusStopDistance(stops[id], stops[id + 1]);
+		}
+		retinfo.curvature = static_cast<double>(retinfo.distance) / retinfo.lenght;
+		return retinfo;
+	}
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "transport_catalogue.h"
+
+namespace transportcatalogue {
+
+	// Бинарный образ справочника. Все ссылки внутри файла - смещения от его начала,
+	// секции выровнены на 8 байт, поэтому образ читается прямо из отображённой памяти.
+	//
+	//   заголовок | пул строк | имена, широты и долготы остановок | имена, признак кольца и остановки
+	//   автобусов (CSR) | расстояния (CSR по остановке отправления, отсортированы по остановке прибытия) |
+	//   автобусы через остановку (CSR, по имени автобуса) | индексы имён остановок и автобусов
+	namespace image {
+
+		inline constexpr char MAGIC[8] = { 'T', 'C', 'I', 'M', 'A', 'G', 'E', '\0' };
+		inline constexpr uint32_t FORMAT_VERSION = 1;
+		inline constexpr uint32_t ENDIAN_MARK = 0x01020304;
+
+		struct Section {
+			uint64_t offset = 0;
+			uint64_t size = 0;
+		};
+
+		struct StringRef {
+			uint32_t offset = 0;
+			uint32_t length = 0;
+		};
+
+		struct DistanceEntry {
+			uint32_t to = 0;
+			int32_t distance = 0;
+		};
+
+		struct Header {
+			char magic[8];
+			uint32_t version = FORMAT_VERSION;
+			uint32_t endian_mark = ENDIAN_MARK;
+			uint64_t file_size = 0;
+			uint32_t stop_count = 0;
+			uint32_t bus_count = 0;
+
+			Section strings;             // char[]
+			Section stop_names;          // StringRef[stop_count]
+			Section stop_lat;            // double[stop_count]
+			Section stop_lng;            // double[stop_count]
+			Section bus_names;           // StringRef[bus_count]
+			Section bus_roundtrip;       // uint8_t[bus_count]
+			Section bus_stop_offsets;    // uint32_t[bus_count + 1]
+			Section bus_stops;           // uint32_t[]
+			Section distance_offsets;    // uint32_t[stop_count + 1]
+			Section distances;           // DistanceEntry[]
+			Section stop_bus_offsets;    // uint32_t[stop_count + 1]
+			Section stop_buses;          // uint32_t[]
+			Section stop_name_index;     // uint32_t[stop_count], номера остановок по возрастанию имени
+			Section bus_name_index;      // uint32_t[bus_count], номера автобусов по возрастанию имени
+		};
+	}
+
+	// Записывает образ загруженного справочника
+	void WriteCatalogueImage(const TransportCatalogue& tc, std::ostream& output);
+	void SaveCatalogueImage(const TransportCatalogue& tc, const std::string& path);
+
+	// Справочник только для чтения поверх отображённого в память образа.
+	// Открытие - проверка заголовка и границ секций, без разбора данных.
+	class CatalogueImage {
+	public:
+		using StopId = uint32_t;
+		using BusId = uint32_t;
+
+		explicit CatalogueImage(const std::string& path);
+		CatalogueImage(const CatalogueImage&) = delete;
+		CatalogueImage& operator=(const CatalogueImage&) = delete;
+		~CatalogueImage();
+
+		size_t GetCountStops() const;
+		size_t GetCountBuses() const;
+
+		std::optional<StopId> FindStop(std::string_view name) const;
+		std::optional<BusId> FindBus(std::string_view name) const;
+
+		std::string_view GetStopName(StopId id) const;
+		Coordinates GetStopCoordinates(StopId id) const;
+		std::string_view GetBusName(BusId id) const;
+		bool IsRoundTrip(BusId id) const;
+		// Полная последовательность остановок маршрута, как в BusInfo::busstop_info
+		std::span<const StopId> GetBusStops(BusId id) const;
+		// Автобусы через остановку, упорядоченные по имени
+		std::span<const BusId> GetBusesByStop(StopId id) const;
+
+		int GetBusStopDistance(StopId from, StopId to) const;
+		std::optional<BusStatistic> GetRouteStatistic(std::string_view bus_name) const;
+
+	private:
+		template <typename T>
+		std::span<const T> GetSection(const image::Section& section) const;
+		std::string_view GetString(image::StringRef ref) const;
+		void Validate() const;
+		void Unmap();
+
+	private:
+		const char* data_ = nullptr;
+		size_t size_ = 0;
+		const image::Header* header_ = nullptr;
+	};
+
+	template <typename T>
+	std::span<const T> CatalogueImage::GetSection(const image::Section& section) const {
+		return { reinterpret_cast<const T*>(data_ + section.offset), static_cast<size_t>(section.size / sizeof(T)) };
+	}
+}
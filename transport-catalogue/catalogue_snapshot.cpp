@@ -0,0 +1,116 @@
+#include "catalogue_snapshot.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace transportcatalogue {
+
+	using namespace std::literals;
+
+	// Эпоха 0 в слоте читателя означает "не читает"
+	constexpr uint64_t IDLE_EPOCH = 0;
+
+	CatalogueSnapshot::CatalogueSnapshot(const CatalogueSnapshot& other)
+		: version(other.version)
+		, catalogue(other.catalogue)
+		, router(catalogue)
+		, renderer(other.renderer.GetSharedMapSettings())
+	{
+		const RoutingSettings& settings = other.router.GetRoutingSettings();
+		router.SetRoutingSettings(settings.bus_wait_time, settings.bus_velocity);
+		router.SetWalkSettings(settings.walk_radius, settings.walk_velocity);
+	}
+
+	SnapshotStore::Handle& SnapshotStore::Handle::operator=(Handle&& other) noexcept {
+		if (this != &other) {
+			Release();
+			snapshot_ = std::exchange(other.snapshot_, nullptr);
+			slot_ = std::exchange(other.slot_, nullptr);
+		}
+		return *this;
+	}
+
+	void SnapshotStore::Handle::Release() {
+		if (slot_ != nullptr) {
+			slot_->epoch.store(IDLE_EPOCH);
+			slot_->in_use.store(false, std::memory_order_release);
+			slot_ = nullptr;
+		}
+		snapshot_ = nullptr;
+	}
+
+	SnapshotStore::~SnapshotStore() {
+		delete current_.load();
+	}
+
+	SnapshotStore::Handle SnapshotStore::Pin() const {
+		for (;;) {
+			for (ReaderSlot& slot : readers_) {
+				bool expected = false;
+				if (slot.in_use.load(std::memory_order_relaxed)
+					|| !slot.in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+					continue;
+				}
+				// Сначала объявляем эпоху, затем читаем указатель: писатель, увидевший эпоху,
+				// не освободит версию, которую мы можем прочитать
+				slot.epoch.store(global_epoch_.load());
+				return Handle{ current_.load(), &slot };
+			}
+			// Все слоты заняты - крайне редкая ситуация, уступаем процессор и пробуем снова
+			std::this_thread::yield();
+		}
+	}
+
+	uint64_t SnapshotStore::Publish(std::unique_ptr<CatalogueSnapshot> next) {
+		std::lock_guard guard(writer_mutex_);
+		return PublishLocked(std::move(next));
+	}
+
+	uint64_t SnapshotStore::PublishLocked(std::unique_ptr<CatalogueSnapshot> next) {
+		if (!next) {
+			throw std::invalid_argument("Snapshot must not be null"s);
+		}
+		next->version = ++last_version_;
+		const uint64_t version = next->version;
+
+		CatalogueSnapshot* previous = current_.exchange(next.release());
+		// Читатели с эпохой меньше retire_epoch могли успеть прочитать previous
+		const uint64_t retire_epoch = global_epoch_.fetch_add(1) + 1;
+		if (previous != nullptr) {
+			retired_.emplace_back(retire_epoch, std::unique_ptr<CatalogueSnapshot>(previous));
+		}
+		ReclaimLocked();
+		return version;
+	}
+
+	void SnapshotStore::Reclaim() {
+		std::lock_guard guard(writer_mutex_);
+		ReclaimLocked();
+	}
+
+	void SnapshotStore::ReclaimLocked() {
+		uint64_t min_active_epoch = UINT64_MAX;
+		for (const ReaderSlot& slot : readers_) {
+			const uint64_t epoch = slot.epoch.load();
+			if (epoch != IDLE_EPOCH && epoch < min_active_epoch) {
+				min_active_epoch = epoch;
+			}
+		}
+
+		auto itr = std::remove_if(retired_.begin(), retired_.end(), [min_active_epoch](const auto& retired) {
+			return retired.first <= min_active_epoch;
+			});
+		retired_.erase(itr, retired_.end());
+	}
+
+	uint64_t SnapshotStore::GetCurrentVersion() const {
+		const CatalogueSnapshot* current = current_.load();
+		return current != nullptr ? current->version : 0;
+	}
+
+	size_t SnapshotStore::GetRetiredCount() const {
+		std::lock_guard guard(writer_mutex_);
+		return retired_.size();
+	}
+}
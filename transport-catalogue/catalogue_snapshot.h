@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+#include "map_renderer.h"
+
+namespace transportcatalogue {
+
+	// Неизменяемая после публикации версия справочника вместе с построенным по ней маршрутизатором.
+	// Объект неперемещаемый: router хранит ссылку на catalogue.
+	struct CatalogueSnapshot {
+		CatalogueSnapshot() = default;
+		// Копия для copy-on-write: данные копируются, настройки отрисовки разделяются, граф маршрутов нужно перестроить
+		CatalogueSnapshot(const CatalogueSnapshot& other);
+		CatalogueSnapshot& operator=(const CatalogueSnapshot&) = delete;
+
+		uint64_t version = 0;
+		TransportCatalogue catalogue;
+		TransportRouter router{ catalogue };
+		renderer::MapRenderer renderer;
+	};
+
+	// Хранилище версий справочника в стиле RCU/epoch-based reclamation.
+	// Читатели закрепляют текущую версию без блокировок: объявляют эпоху в своём слоте и читают указатель.
+	// Писатель собирает следующую версию, атомарно публикует её, а старую освобождает только тогда,
+	// когда ни один читатель, закрепивший её, не остался активным.
+	class SnapshotStore {
+	private:
+		struct ReaderSlot {
+			std::atomic<bool> in_use{ false };
+			std::atomic<uint64_t> epoch{ 0 };
+		};
+
+	public:
+		static constexpr size_t MAX_READERS = 128;
+
+		// RAII-дескриптор закреплённой версии. Пока он жив, версия не будет освобождена.
+		class Handle {
+		public:
+			Handle() = default;
+			Handle(const CatalogueSnapshot* snapshot, ReaderSlot* slot) : snapshot_(snapshot), slot_(slot) {}
+			Handle(Handle&& other) noexcept
+				: snapshot_(std::exchange(other.snapshot_, nullptr))
+				, slot_(std::exchange(other.slot_, nullptr)) {}
+			Handle& operator=(Handle&& other) noexcept;
+			Handle(const Handle&) = delete;
+			Handle& operator=(const Handle&) = delete;
+			~Handle() {
+				Release();
+			}
+
+			explicit operator bool() const {
+				return snapshot_ != nullptr;
+			}
+			const CatalogueSnapshot& operator*() const {
+				return *snapshot_;
+			}
+			const CatalogueSnapshot* operator->() const {
+				return snapshot_;
+			}
+			const CatalogueSnapshot* Get() const {
+				return snapshot_;
+			}
+
+		private:
+			void Release();
+
+			const CatalogueSnapshot* snapshot_ = nullptr;
+			ReaderSlot* slot_ = nullptr;
+		};
+
+		SnapshotStore() = default;
+		SnapshotStore(const SnapshotStore&) = delete;
+		SnapshotStore& operator=(const SnapshotStore&) = delete;
+		~SnapshotStore();
+
+		// Путь чтения: только атомарные операции, без мьютексов
+		Handle Pin() const;
+
+		// Публикует новую версию и возвращает её номер. Предыдущая версия уходит в список на освобождение.
+		uint64_t Publish(std::unique_ptr<CatalogueSnapshot> next);
+
+		// Copy-on-write обновление: копия текущей версии -> updater -> перестроение графа -> публикация.
+		// Писатели сериализуются между собой, читатели при этом не останавливаются.
+		template <typename Updater>
+		uint64_t Update(Updater&& updater);
+
+		// Освобождает отложенные версии, которые больше никем не закреплены
+		void Reclaim();
+
+		uint64_t GetCurrentVersion() const;
+		size_t GetRetiredCount() const;
+
+	private:
+		uint64_t PublishLocked(std::unique_ptr<CatalogueSnapshot> next);
+		void ReclaimLocked();
+
+	private:
+		std::atomic<CatalogueSnapshot*> current_{ nullptr };
+		std::atomic<uint64_t> global_epoch_{ 1 };
+		mutable std::array<ReaderSlot, MAX_READERS> readers_;
+
+		mutable std::mutex writer_mutex_;
+		uint64_t last_version_ = 0;
+		std::vector<std::pair<uint64_t, std::unique_ptr<CatalogueSnapshot>>> retired_;
+	};
+
+	template <typename Updater>
+	uint64_t SnapshotStore::Update(Updater&& updater) {
+		std::lock_guard guard(writer_mutex_);
+		const CatalogueSnapshot* current = current_.load();
+		std::unique_ptr<CatalogueSnapshot> next = current != nullptr
+			? std::make_unique<CatalogueSnapshot>(*current)
+			: std::make_unique<CatalogueSnapshot>();
+		updater(*next);
+		next->router.BuildGraphRoute();
+		return PublishLocked(std::move(next));
+	}
+}
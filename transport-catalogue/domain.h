@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include "geo.h"
 
@@ -10,14 +11,11 @@ using namespace geo;
 namespace transportcatalogue {
 
 	struct StopInfo {
-		string name;
+		// Строку имени хранит справочник, которому принадлежит запись
+		string_view name;
 		Coordinates coordinates;
-	};
-
-	struct BusInfo {
-		string name;
-		vector<const StopInfo*> busstop_info;
-		bool type = false;
+		// Номер остановки в справочнике, индекс в массивах предвычисленных данных
+		size_t id = 0;
 	};
 
 	struct BusStatistic {
@@ -28,13 +26,29 @@ namespace transportcatalogue {
 		double curvature = 0.0;
 	};
 
+	struct BusInfo {
+		string_view name;
+		vector<const StopInfo*> busstop_info;
+		bool type = false;
+		// Заполняется TransportCatalogue::PrecomputeStatistics и поддерживается при изменениях справочника
+		BusStatistic statistic;
+	};
+
 	struct RoutingSettings {
 		int bus_wait_time = 0;
 		int bus_velocity = 0;
+		// Пешие переходы между остановками не дальше walk_radius метров, скорость walk_velocity км/ч;
+		// нулевые значения отключают переходы
+		double walk_radius = 0.0;
+		double walk_velocity = 0.0;
 		void SetParams(int wait, int velocity) {
 			bus_wait_time = wait > 0 ? wait : 0;
 			bus_velocity = velocity > 0 ? velocity : 0;
 		}
+		void SetWalkParams(double radius, double velocity) {
+			walk_radius = radius > 0 ? radius : 0.0;
+			walk_velocity = velocity > 0 ? velocity : 0.0;
+		}
 	};
 
 	using BusPtr = const BusInfo*;
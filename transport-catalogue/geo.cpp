@@ -1,10 +1,29 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace geo {
 
+    namespace {
+        const double DR = M_PI / 180.0;
+        // Размер блока: промежуточные массивы помещаются в L1 и цикл по ним векторизуется компилятором
+        constexpr size_t BATCH_BLOCK = 256;
+
+        double ArcToDistance(double dot) {
+            return std::acos(std::clamp(dot, -1.0, 1.0)) * EARTH_RADIUS;
+        }
+
+        // Скалярные произведения пар векторов, предварительно собранных в непрерывные массивы
+        void DotProducts(const double* ax, const double* ay, const double* az,
+            const double* bx, const double* by, const double* bz, size_t count, double* result) {
+            for (size_t i = 0; i < count; ++i) {
+                result[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+            }
+        }
+    }
+
     double ComputeDistance(Coordinates from, Coordinates to) {
         using namespace std;
         const double dr = M_PI / 180.0;
@@ -13,4 +32,134 @@ namespace geo {
             * 6371000;
     }
 
-}  // namespace geo
\ No newline at end of file
+    void UnitVectors::Reserve(size_t count) {
+        x_.reserve(count);
+        y_.reserve(count);
+        z_.reserve(count);
+    }
+
+    void UnitVectors::Resize(size_t count) {
+        x_.resize(count);
+        y_.resize(count);
+        z_.resize(count);
+    }
+
+    size_t UnitVectors::Add(Coordinates point) {
+        x_.push_back(0.0);
+        y_.push_back(0.0);
+        z_.push_back(0.0);
+        Set(x_.size() - 1, point);
+        return x_.size() - 1;
+    }
+
+    void UnitVectors::Set(size_t id, Coordinates point) {
+        const double lat = point.lat * DR;
+        const double lng = point.lng * DR;
+        x_[id] = std::cos(lat) * std::cos(lng);
+        y_[id] = std::cos(lat) * std::sin(lng);
+        z_[id] = std::sin(lat);
+    }
+
+    size_t UnitVectors::GetSize() const {
+        return x_.size();
+    }
+
+    void UnitVectors::ReportMemory(memory::MemoryReport& report, const std::string& prefix) const {
+        report.Add(prefix, "xyz", memory::HeapBytes(x_) + memory::HeapBytes(y_) + memory::HeapBytes(z_), x_.size());
+    }
+
+    const double* UnitVectors::GetX() const {
+        return x_.data();
+    }
+
+    const double* UnitVectors::GetY() const {
+        return y_.data();
+    }
+
+    const double* UnitVectors::GetZ() const {
+        return z_.data();
+    }
+
+    double ComputeDistance(const UnitVectors& points, size_t from, size_t to) {
+        const double dot = points.GetX()[from] * points.GetX()[to]
+            + points.GetY()[from] * points.GetY()[to]
+            + points.GetZ()[from] * points.GetZ()[to];
+        return ArcToDistance(dot);
+    }
+
+    void ComputeRouteDistances(const UnitVectors& points, const size_t* ids, size_t count, double* result) {
+        if (count < 2) {
+            return;
+        }
+        const double* x = points.GetX();
+        const double* y = points.GetY();
+        const double* z = points.GetZ();
+
+        // Собираем блок из BATCH_BLOCK + 1 точек, чтобы пары (i, i + 1) лежали в одном массиве со сдвигом
+        double bx[BATCH_BLOCK + 1];
+        double by[BATCH_BLOCK + 1];
+        double bz[BATCH_BLOCK + 1];
+
+        const size_t segments = count - 1;
+        for (size_t begin = 0; begin < segments; begin += BATCH_BLOCK) {
+            const size_t block = std::min(BATCH_BLOCK, segments - begin);
+            for (size_t i = 0; i <= block; ++i) {
+                const size_t id = ids[begin + i];
+                bx[i] = x[id];
+                by[i] = y[id];
+                bz[i] = z[id];
+            }
+            DotProducts(bx, by, bz, bx + 1, by + 1, bz + 1, block, result + begin);
+            for (size_t i = 0; i < block; ++i) {
+                result[begin + i] = ArcToDistance(result[begin + i]);
+            }
+        }
+    }
+
+    double ComputeRouteLength(const UnitVectors& points, const size_t* ids, size_t count) {
+        if (count < 2) {
+            return 0.0;
+        }
+        double distances[BATCH_BLOCK];
+        double length = 0.0;
+        for (size_t begin = 0; begin + 1 < count; begin += BATCH_BLOCK) {
+            const size_t block = std::min(BATCH_BLOCK, count - 1 - begin);
+            ComputeRouteDistances(points, ids + begin, block + 1, distances);
+            for (size_t i = 0; i < block; ++i) {
+                length += distances[i];
+            }
+        }
+        return length;
+    }
+
+    void ComputeDistancesFrom(Coordinates point, const UnitVectors& points, const size_t* ids, size_t count, double* result) {
+        const double px = std::cos(point.lat * DR) * std::cos(point.lng * DR);
+        const double py = std::cos(point.lat * DR) * std::sin(point.lng * DR);
+        const double pz = std::sin(point.lat * DR);
+        const double* x = points.GetX();
+        const double* y = points.GetY();
+        const double* z = points.GetZ();
+
+        double bx[BATCH_BLOCK];
+        double by[BATCH_BLOCK];
+        double bz[BATCH_BLOCK];
+
+        for (size_t begin = 0; begin < count; begin += BATCH_BLOCK) {
+            const size_t block = std::min(BATCH_BLOCK, count - begin);
+            for (size_t i = 0; i < block; ++i) {
+                const size_t id = ids[begin + i];
+                bx[i] = x[id];
+                by[i] = y[id];
+                bz[i] = z[id];
+            }
+            double* out = result + begin;
+            for (size_t i = 0; i < block; ++i) {
+                out[i] = px * bx[i] + py * by[i] + pz * bz[i];
+            }
+            for (size_t i = 0; i < block; ++i) {
+                out[i] = ArcToDistance(out[i]);
+            }
+        }
+    }
+
+}  // namespace geo
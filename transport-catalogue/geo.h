@@ -1,4 +1,11 @@
 #pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "memory_report.h"
+
 namespace geo {
 
     struct Coordinates {
@@ -8,4 +15,44 @@ namespace geo {
 
     double ComputeDistance(Coordinates from, Coordinates to);
 
+    // Радиус сферы, используемый во всех расчётах расстояний
+    inline constexpr double EARTH_RADIUS = 6371000;
+
+    // Пакетные функции считают ту же формулу через скалярное произведение заранее вычисленных
+    // единичных векторов. Расхождение с ComputeDistance - только ошибка округления:
+    // не более BATCH_DISTANCE_TOLERANCE метров для точек, разнесённых хотя бы на метр и не ближе метра к антиподу.
+    // Ошибка acos вблизи 1 в обеих формулах растёт как R^2 * eps / d: на метре около 1e-2 м, на километре порядка 1e-5 м.
+    // Проверка допуска - bench/geo_tolerance.cpp
+    inline constexpr double BATCH_DISTANCE_TOLERANCE = 2e-2;
+
+    // Координаты точек, разложенные в структуру массивов (x, y, z единичного вектора)
+    class UnitVectors {
+    public:
+        void Reserve(size_t count);
+        // Новые точки заполняются нулями и задаются через Set
+        void Resize(size_t count);
+        size_t Add(Coordinates point);
+        void Set(size_t id, Coordinates point);
+        size_t GetSize() const;
+        void ReportMemory(memory::MemoryReport& report, const std::string& prefix) const;
+
+        const double* GetX() const;
+        const double* GetY() const;
+        const double* GetZ() const;
+
+    private:
+        std::vector<double> x_;
+        std::vector<double> y_;
+        std::vector<double> z_;
+    };
+
+    double ComputeDistance(const UnitVectors& points, size_t from, size_t to);
+
+    // Расстояния между соседними точками маршрута ids[0..count): result[i] = |ids[i], ids[i + 1]|
+    void ComputeRouteDistances(const UnitVectors& points, const size_t* ids, size_t count, double* result);
+    double ComputeRouteLength(const UnitVectors& points, const size_t* ids, size_t count);
+
+    // Расстояния от point до каждой точки набора кандидатов ids[0..count)
+    void ComputeDistancesFrom(Coordinates point, const UnitVectors& points, const size_t* ids, size_t count, double* result);
+
 }  // namespace geo
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "ranges.h"
+#include "memory_report.h"
 
 #include <cstdlib>
+#include <string>
 #include <vector>
 
 namespace graph {
@@ -32,6 +34,7 @@ namespace graph {
         size_t GetEdgeCount() const;
         const Edge<Weight>& GetEdge(EdgeId edge_id) const;
         IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+        void ReportMemory(memory::MemoryReport& report, const std::string& prefix) const;
 
     private:
         std::vector<Edge<Weight>> edges_;
@@ -71,4 +74,14 @@ namespace graph {
         DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
         return tc_ranges::AsRange(incidence_lists_.at(vertex));
     }
+
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::ReportMemory(memory::MemoryReport& report, const std::string& prefix) const {
+        report.Add(prefix, "edges", memory::HeapBytes(edges_), edges_.size());
+        size_t bytes = memory::HeapBytes(incidence_lists_);
+        for (const IncidenceList& list : incidence_lists_) {
+            bytes += memory::HeapBytes(list);
+        }
+        report.Add(prefix, "incidence_lists", bytes, incidence_lists_.size());
+    }
 }  // namespace graph
\ No newline at end of file
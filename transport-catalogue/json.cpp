@@ -1,367 +1,310 @@
 #include "json.h"
 
-#include <iterator>
+#include "json_scan.h"
+#include "json_writer.h"
+
+#include <cctype>
 
 namespace json {
 
     namespace {
         using namespace std::literals;
 
-        Node LoadNode(std::istream& input);
-        Node LoadString(std::istream& input);
+        // Разбор документа из непрерывного буфера. Грамматика и сообщения об ошибках те же,
+        // что у прежнего посимвольного чтения из std::istream: пробелы пропускаются как у operator>>,
+        // после корневого узла остаток буфера не читается. Массивы и словари размещаются в resource.
+        // При share_strings строковые значения без escape-последовательностей ссылаются на input
+        class Parser {
+        public:
+            Parser(std::string_view input, std::pmr::memory_resource* resource, bool share_strings)
+                : pos_(input.data())
+                , end_(input.data() + input.size())
+                , resource_(resource)
+                , share_strings_(share_strings) {
+            }
+
+            Node LoadNode() {
+                char c;
+                if (!ReadChar(c)) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                switch (c) {
+                case '[':
+                    return LoadArray();
+                case '{':
+                    return LoadDict();
+                case '"':
+                    return LoadStringNode();
+                case 't':
+                    // Встретив t или f, переходим к попытке парсинга литералов true либо false
+                    [[fallthrough]];
+                case 'f':
+                    PutBack();
+                    return LoadBool();
+                case 'n':
+                    PutBack();
+                    return LoadNull();
+                default:
+                    PutBack();
+                    return LoadNumber();
+                }
+            }
 
-        std::string LoadLiteral(std::istream& input) {
-            std::string s;
-            while (std::isalpha(input.peek())) {
-                s.push_back(static_cast<char>(input.get()));
+        private:
+            // Аналог input >> c
+            bool ReadChar(char& c) {
+                pos_ = scan::SkipSpaces(pos_, end_);
+                if (pos_ == end_) {
+                    return false;
+                }
+                c = *pos_++;
+                return true;
             }
-            return s;
-        }
 
-        Node LoadArray(std::istream& input) {
-            std::vector<Node> result;
+            void PutBack() {
+                --pos_;
+            }
 
-            for (char c; input >> c && c != ']';) {
-                if (c != ',') {
-                    input.putback(c);
+            int Peek() const {
+                return pos_ != end_ ? static_cast<unsigned char>(*pos_) : std::char_traits<char>::eof();
+            }
+
+            std::string_view LoadLiteral() {
+                const char* begin = pos_;
+                while (pos_ != end_ && std::isalpha(static_cast<unsigned char>(*pos_))) {
+                    ++pos_;
                 }
-                result.push_back(LoadNode(input));
+                return { begin, static_cast<size_t>(pos_ - begin) };
             }
-            if (!input) {
-                throw ParsingError("Array parsing error"s);
+
+            Node LoadArray() {
+                Array result(resource_);
+
+                char c;
+                bool closed = false;
+                while (ReadChar(c)) {
+                    if (c == ']') {
+                        closed = true;
+                        break;
+                    }
+                    if (c != ',') {
+                        PutBack();
+                    }
+                    result.push_back(LoadNode());
+                }
+                if (!closed) {
+                    throw ParsingError("Array parsing error"s);
+                }
+                return Node(std::move(result));
             }
-            return Node(std::move(result));
-        }
 
-        Node LoadDict(std::istream& input) {
-            Dict dict;
+            Node LoadDict() {
+                scan::DictScratch::Level& level = dict_scratch_.Open();
 
-            for (char c; input >> c && c != '}';) {
-                if (c == '"') {
-                    std::string key = LoadString(input).AsString();
-                    if (input >> c && c == ':') {
-                        if (dict.find(key) != dict.end()) {
-                            throw ParsingError("Duplicate key '"s + key + "' have been found");
+                char c;
+                bool closed = false;
+                while (ReadChar(c)) {
+                    if (c == '}') {
+                        closed = true;
+                        break;
+                    }
+                    if (c == '"') {
+                        std::string key = LoadString();
+                        if (ReadChar(c) && c == ':') {
+                            const size_t position = level.FindPosition(key);
+                            Node value = LoadNode();
+                            level.Insert(position, std::move(key), std::move(value));
+                        }
+                        else {
+                            throw ParsingError(": is expected but '"s + c + "' has been found"s);
                         }
-                        dict.emplace(std::move(key), LoadNode(input));
                     }
-                    else {
-                        throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                    else if (c != ',') {
+                        throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
                     }
                 }
-                else if (c != ',') {
-                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                if (!closed) {
+                    throw ParsingError("Dictionary parsing error"s);
                 }
+                return Node(dict_scratch_.Close(resource_));
             }
-            if (!input) {
-                throw ParsingError("Dictionary parsing error"s);
-            }
-            return Node(std::move(dict));
-        }
 
-        Node LoadString(std::istream& input) {
-            auto it = std::istreambuf_iterator<char>(input);
-            auto end = std::istreambuf_iterator<char>();
-            std::string s;
-            while (true) {
-                if (it == end) {
-                    throw ParsingError("String parsing error");
-                }
-                const char ch = *it;
-                if (ch == '"') {
-                    ++it;
-                    break;
+            // Открывающая кавычка уже прочитана
+            Node LoadStringNode() {
+                if (share_strings_) {
+                    const char* special = scan::FindStringSpecial(pos_, end_);
+                    if (special != end_ && *special == '"') {
+                        const std::string_view value(pos_, static_cast<size_t>(special - pos_));
+                        pos_ = special + 1;
+                        return Node(StringRef{ value });
+                    }
                 }
-                else if (ch == '\\') {
-                    ++it;
-                    if (it == end) {
+                return Node(LoadString());
+            }
+
+            // Открывающая кавычка уже прочитана
+            std::string LoadString() {
+                std::string s;
+                while (true) {
+                    const char* special = scan::FindStringSpecial(pos_, end_);
+                    s.append(pos_, special);
+                    pos_ = special;
+                    if (pos_ == end_) {
                         throw ParsingError("String parsing error");
                     }
-                    const char escaped_char = *(it);
-                    switch (escaped_char) {
-                    case 'n':
-                        s.push_back('\n');
-                        break;
-                    case 't':
-                        s.push_back('\t');
-                        break;
-                    case 'r':
-                        s.push_back('\r');
+                    const char ch = *pos_++;
+                    if (ch == '"') {
                         break;
-                    case '"':
-                        s.push_back('"');
-                        break;
-                    case '\\':
-                        s.push_back('\\');
-                        break;
-                    default:
-                        throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
                     }
+                    if (ch != '\\') {
+                        throw ParsingError("Unexpected end of line"s);
+                    }
+                    if (pos_ == end_) {
+                        throw ParsingError("String parsing error");
+                    }
+                    s.push_back(scan::Unescape(*pos_++));
                 }
-                else if (ch == '\n' || ch == '\r') {
-                    throw ParsingError("Unexpected end of line"s);
+                return s;
+            }
+
+            Node LoadBool() {
+                const std::string_view s = LoadLiteral();
+                if (s == "true"sv) {
+                    return Node{ true };
+                }
+                else if (s == "false"sv) {
+                    return Node{ false };
                 }
                 else {
-                    s.push_back(ch);
+                    throw ParsingError("Failed to parse '"s + std::string(s) + "' as bool"s);
                 }
-                ++it;
             }
 
-            return Node(std::move(s));
-        }
-
-        Node LoadBool(std::istream& input) {
-            const auto s = LoadLiteral(input);
-            if (s == "true"sv) {
-                return Node{ true };
-            }
-            else if (s == "false"sv) {
-                return Node{ false };
-            }
-            else {
-                throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+            Node LoadNull() {
+                if (const std::string_view literal = LoadLiteral(); literal == "null"sv) {
+                    return Node{ nullptr };
+                }
+                else {
+                    throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+                }
             }
-        }
 
-        Node LoadNull(std::istream& input) {
-            if (auto literal = LoadLiteral(input); literal == "null"sv) {
-                return Node{ nullptr };
-            }
-            else {
-                throw ParsingError("Failed to parse '"s + literal + "' as null"s);
-            }
-        }
+            Node LoadNumber() {
+                const char* begin = pos_;
 
-        Node LoadNumber(std::istream& input) {
-            std::string parsed_num;
+                // Пропускает одну или более цифр
+                auto read_digits = [this] {
+                    if (!scan::IsDigit(Peek())) {
+                        throw ParsingError("A digit is expected"s);
+                    }
+                    while (scan::IsDigit(Peek())) {
+                        ++pos_;
+                    }
+                };
 
-            // Считывает в parsed_num очередной символ из input
-            auto read_char = [&parsed_num, &input] {
-                parsed_num += static_cast<char>(input.get());
-                if (!input) {
-                    throw ParsingError("Failed to read number from stream"s);
+                if (Peek() == '-') {
+                    ++pos_;
                 }
-            };
-
-            // Считывает одну или более цифр в parsed_num из input
-            auto read_digits = [&input, read_char] {
-                if (!std::isdigit(input.peek())) {
-                    throw ParsingError("A digit is expected"s);
+                // Парсим целую часть числа
+                if (Peek() == '0') {
+                    ++pos_;
+                    // После 0 в JSON не могут идти другие цифры
                 }
-                while (std::isdigit(input.peek())) {
-                    read_char();
+                else {
+                    read_digits();
                 }
-            };
-
-            if (input.peek() == '-') {
-                read_char();
-            }
-            // Парсим целую часть числа
-            if (input.peek() == '0') {
-                read_char();
-                // После 0 в JSON не могут идти другие цифры
-            }
-            else {
-                read_digits();
-            }
 
-            bool is_int = true;
-            // Парсим дробную часть числа
-            if (input.peek() == '.') {
-                read_char();
-                read_digits();
-                is_int = false;
-            }
-
-            // Парсим экспоненциальную часть числа
-            if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-                read_char();
-                if (ch = input.peek(); ch == '+' || ch == '-') {
-                    read_char();
+                bool is_int = true;
+                // Парсим дробную часть числа
+                if (Peek() == '.') {
+                    ++pos_;
+                    read_digits();
+                    is_int = false;
                 }
-                read_digits();
-                is_int = false;
-            }
 
-            try {
-                if (is_int) {
-                    // Сначала пробуем преобразовать строку в int
-                    try {
-                        return std::stoi(parsed_num);
-                    }
-                    catch (...) {
-                        // В случае неудачи, например, при переполнении
-                        // код ниже попробует преобразовать строку в double
+                // Парсим экспоненциальную часть числа
+                if (int ch = Peek(); ch == 'e' || ch == 'E') {
+                    ++pos_;
+                    if (ch = Peek(); ch == '+' || ch == '-') {
+                        ++pos_;
                     }
+                    read_digits();
+                    is_int = false;
                 }
-                return std::stod(parsed_num);
-            }
-            catch (...) {
-                throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
-            }
-        }
 
-        Node LoadNode(std::istream& input) {
-            char c;
-            if (!(input >> c)) {
-                throw ParsingError("Unexpected EOF"s);
+                return scan::ToNumber(std::string_view(begin, static_cast<size_t>(pos_ - begin)), is_int);
             }
-            switch (c) {
-            case '[':
-                return LoadArray(input);
-            case '{':
-                return LoadDict(input);
-            case '"':
-                return LoadString(input);
-            case 't':
-                // Атрибут [[fallthrough]] (провалиться) ничего не делает, и является
-                // подсказкой компилятору и человеку, что здесь программист явно задумывал
-                // разрешить переход к инструкции следующей ветки case, а не случайно забыл
-                // написать break, return или throw.
-                // В данном случае, встретив t или f, переходим к попытке парсинга
-                // литералов true либо false
-                [[fallthrough]];
-            case 'f':
-                input.putback(c);
-                return LoadBool(input);
-            case 'n':
-                input.putback(c);
-                return LoadNull(input);
-            default:
-                input.putback(c);
-                return LoadNumber(input);
-            }
-        }
 
-        struct PrintContext {
-            std::ostream& out;
-            int indent_step = 4;
-            int indent = 0;
-
-            void PrintIndent() const {
-                for (int i = 0; i < indent; ++i) {
-                    out.put(' ');
-                }
-            }
-
-            PrintContext Indented() const {
-                return { out, indent_step, indent_step + indent };
-            }
+        private:
+            const char* pos_;
+            const char* end_;
+            std::pmr::memory_resource* resource_;
+            bool share_strings_;
+            scan::DictScratch dict_scratch_;
         };
+    }  // namespace
 
-        void PrintNode(const Node& value, const PrintContext& ctx);
-
-        template <typename Value>
-        void PrintValue(const Value& value, const PrintContext& ctx) {
-            ctx.out << value;
-        }
+    Document Load(std::string_view input) {
+        auto arena = std::make_unique<Arena>();
+        Node root = Parser(input, arena.get(), false).LoadNode();
+        return Document(std::move(arena), std::move(root));
+    }
 
-        void PrintString(const std::string& value, std::ostream& out) {
-            out.put('"');
-            for (const char c : value) {
-                switch (c) {
-                case '\r':
-                    out << "\\r"sv;
-                    break;
-                case '\n':
-                    out << "\\n"sv;
-                    break;
-                case '\t':
-                    out << "\\t"sv;
-                    break;
-                case '"':
-                    // Символы " и \ выводятся как \" или \\, соответственно
-                    [[fallthrough]];
-                case '\\':
-                    out.put('\\');
-                    [[fallthrough]];
-                default:
-                    out.put(c);
-                    break;
-                }
-            }
-            out.put('"');
-        }
+    Document Load(std::shared_ptr<const std::string> input) {
+        auto arena = std::make_unique<Arena>();
+        Node root = Parser(*input, arena.get(), true).LoadNode();
+        return Document(std::move(input), std::move(arena), std::move(root));
+    }
 
-        template <>
-        void PrintValue<std::string>(const std::string& value, const PrintContext& ctx) {
-            PrintString(value, ctx.out);
-        }
+    Document Load(std::istream& input) {
+        return Load(scan::ReadAll(input));
+    }
 
-        template <>
-        void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
-            ctx.out << "null"sv;
-        }
+    void Print(const Document& doc, std::ostream& output, const PrintOptions& options) {
+        Writer(output, options).WriteNode(doc.GetRoot()).Finish();
+    }
 
-        // В специализации шаблона PrintValue для типа bool параметр value передаётся
-        // по константной ссылке, как и в основном шаблоне.
-        // В качестве альтернативы можно использовать перегрузку:
-        // void PrintValue(bool value, const PrintContext& ctx);
-        template <>
-        void PrintValue<bool>(const bool& value, const PrintContext& ctx) {
-            ctx.out << (value ? "true"sv : "false"sv);
-        }
+    namespace {
+        struct DomUsage {
+            memory::MemoryUsage arrays;
+            memory::MemoryUsage dicts;
+            memory::MemoryUsage strings;
+        };
 
-        template <>
-        void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
-            std::ostream& out = ctx.out;
-            out << "[\n"sv;
-            bool first = true;
-            auto inner_ctx = ctx.Indented();
-            for (const Node& node : nodes) {
-                if (first) {
-                    first = false;
-                }
-                else {
-                    out << ",\n"sv;
+        void CollectDomUsage(const Node& node, DomUsage& usage) {
+            if (node.IsArray()) {
+                const Array& array = node.AsArray();
+                ++usage.arrays.count;
+                usage.arrays.bytes += memory::HeapBytes(array);
+                for (const Node& item : array) {
+                    CollectDomUsage(item, usage);
                 }
-                inner_ctx.PrintIndent();
-                PrintNode(node, inner_ctx);
             }
-            out.put('\n');
-            ctx.PrintIndent();
-            out.put(']');
-        }
-
-        template <>
-        void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
-            std::ostream& out = ctx.out;
-            out << "{\n"sv;
-            bool first = true;
-            auto inner_ctx = ctx.Indented();
-            for (const auto& [key, node] : nodes) {
-                if (first) {
-                    first = false;
+            else if (node.IsDict()) {
+                const Dict& dict = node.AsDict();
+                ++usage.dicts.count;
+                usage.dicts.bytes += dict.capacity() * sizeof(Dict::value_type);
+                for (const auto& [key, value] : dict) {
+                    usage.dicts.bytes += memory::HeapBytes(key);
+                    CollectDomUsage(value, usage);
                 }
-                else {
-                    out << ",\n"sv;
+            }
+            else if (node.IsString()) {
+                // Строки-ссылки на вход своей памяти не занимают
+                ++usage.strings.count;
+                if (const auto* value = std::get_if<std::string>(&node.GetValue())) {
+                    usage.strings.bytes += memory::HeapBytes(*value);
                 }
-                inner_ctx.PrintIndent();
-                PrintString(key, ctx.out);
-                out << ": "sv;
-                PrintNode(node, inner_ctx);
             }
-            out.put('\n');
-            ctx.PrintIndent();
-            out.put('}');
         }
-
-        void PrintNode(const Node& node, const PrintContext& ctx) {
-            std::visit(
-                [&ctx](const auto& value) {
-                    PrintValue(value, ctx);
-                },
-                node.GetValue());
-        }
-
-    }  // namespace
-
-    Document Load(std::istream& input) {
-        return Document{ LoadNode(input) };
     }
 
-    void Print(const Document& doc, std::ostream& output) {
-        PrintNode(doc.GetRoot(), PrintContext{ output });
+    void ReportMemory(const Document& doc, memory::MemoryReport& report, const std::string& prefix) {
+        DomUsage usage;
+        CollectDomUsage(doc.GetRoot(), usage);
+        report.Add(prefix, "arrays", usage.arrays.bytes, usage.arrays.count);
+        report.Add(prefix, "dicts", usage.dicts.bytes, usage.dicts.count);
+        report.Add(prefix, "strings", usage.strings.bytes, usage.strings.count);
     }
 
 }  // namespace json
\ No newline at end of file
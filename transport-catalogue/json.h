@@ -1,16 +1,95 @@
 #pragma once
 
+#include <algorithm>
+#include <initializer_list>
 #include <iostream>
-#include <map>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "memory_report.h"
+
 namespace json {
 
     class Node;
-    using Dict = std::map<std::string, Node>;
-    using Array = std::vector<Node>;
+
+    // Словарь JSON - отсортированный по ключу вектор пар. Объекты входа и ответов содержат
+    // по нескольку ключей, а непрерывный массив не выделяет память под каждый ключ и быстрее дерева
+    // и при поиске, и при обходе. Интерфейс - подмножество std::map с тем же порядком обхода.
+    // Вставка в середину сдвигает хвост, поэтому словарь рассчитан на небольшие объекты.
+    // Память под пары берётся из memory_resource словаря, копия словаря использует обычную кучу
+    class FlatDict {
+    public:
+        using key_type = std::string;
+        using mapped_type = Node;
+        using value_type = std::pair<std::string, Node>;
+        using iterator = std::pmr::vector<value_type>::iterator;
+        using const_iterator = std::pmr::vector<value_type>::const_iterator;
+
+        FlatDict() = default;
+        explicit FlatDict(std::pmr::memory_resource* resource)
+            : items_(resource) {
+        }
+        FlatDict(std::initializer_list<value_type> items);
+
+        iterator begin() { return items_.begin(); }
+        iterator end() { return items_.end(); }
+        const_iterator begin() const { return items_.begin(); }
+        const_iterator end() const { return items_.end(); }
+
+        size_t size() const { return items_.size(); }
+        bool empty() const { return items_.empty(); }
+        size_t capacity() const { return items_.capacity(); }
+        void reserve(size_t count) { items_.reserve(count); }
+        void clear() { items_.clear(); }
+
+        iterator find(std::string_view key);
+        const_iterator find(std::string_view key) const;
+        size_t count(std::string_view key) const;
+        Node& at(std::string_view key);
+        const Node& at(std::string_view key) const;
+
+        Node& operator[](std::string key);
+        // Если ключ уже есть, словарь не меняется и возвращается существующий элемент
+        std::pair<iterator, bool> emplace(std::string key, Node value);
+        size_t erase(std::string_view key);
+
+    private:
+        // До этого размера линейный просмотр быстрее двоичного поиска
+        static constexpr size_t LINEAR_SEARCH_LIMIT = 8;
+
+        // Первый элемент с ключом не меньше key
+        const_iterator LowerBound(std::string_view key) const;
+
+    private:
+        std::pmr::vector<value_type> items_;
+    };
+
+    bool operator==(const FlatDict& lhs, const FlatDict& rhs);
+    bool operator!=(const FlatDict& lhs, const FlatDict& rhs);
+
+    using Dict = FlatDict;
+    // Как и у словаря, память элементов массива берётся из его memory_resource
+    using Array = std::pmr::vector<Node>;
+
+    // Монотонная арена для узлов документа: память выделяется крупными блоками, освобождение
+    // отдельных узлов ничего не делает, а вся арена освобождается за один раз вместе с документом
+    using Arena = std::pmr::monotonic_buffer_resource;
+
+    // Строка без escape-последовательностей, которая ссылается на буфер входа документа.
+    // Не конструируется неявно из литерала, чтобы Value("...") по-прежнему создавал std::string
+    struct StringRef {
+        std::string_view value;
+    };
+
+    inline bool operator==(StringRef lhs, StringRef rhs) {
+        return lhs.value == rhs.value;
+    }
 
     class ParsingError : public std::runtime_error {
     public:
@@ -18,7 +97,7 @@ namespace json {
     };
 
     class Node final
-        : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string> {
+        : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string, StringRef> {
     public:
         using variant::variant;
         using Value = variant;
@@ -79,10 +158,14 @@ namespace json {
         }
 
         bool IsString() const {
-            return std::holds_alternative<std::string>(*this);
+            return std::holds_alternative<std::string>(*this) || std::holds_alternative<StringRef>(*this);
         }
-        const std::string& AsString() const {
+        // Строка узла: своя или ссылка на буфер входа, который живёт вместе с документом
+        std::string_view AsString() const {
             using namespace std::literals;
+            if (const auto* ref = std::get_if<StringRef>(this)) {
+                return ref->value;
+            }
             if (!IsString()) {
                 throw std::logic_error("Not a string"s);
             }
@@ -103,6 +186,10 @@ namespace json {
         }
 
         bool operator==(const Node& rhs) const {
+            // Своя строка и ссылка на буфер с тем же текстом равны
+            if (IsString() && rhs.IsString()) {
+                return AsString() == rhs.AsString();
+            }
             return GetValue() == rhs.GetValue();
         }
 
@@ -120,17 +207,131 @@ namespace json {
         return !(lhs == rhs);
     }
 
+    inline FlatDict::FlatDict(std::initializer_list<value_type> items) {
+        items_.reserve(items.size());
+        for (const value_type& item : items) {
+            emplace(item.first, item.second);
+        }
+    }
+
+    inline FlatDict::const_iterator FlatDict::LowerBound(std::string_view key) const {
+        if (items_.size() <= LINEAR_SEARCH_LIMIT) {
+            auto itr = items_.begin();
+            while (itr != items_.end() && std::string_view(itr->first) < key) {
+                ++itr;
+            }
+            return itr;
+        }
+        return std::lower_bound(items_.begin(), items_.end(), key,
+            [](const value_type& item, std::string_view key) { return std::string_view(item.first) < key; });
+    }
+
+    inline FlatDict::const_iterator FlatDict::find(std::string_view key) const {
+        const_iterator itr = LowerBound(key);
+        return itr != items_.end() && itr->first == key ? itr : items_.end();
+    }
+
+    inline FlatDict::iterator FlatDict::find(std::string_view key) {
+        return items_.begin() + (std::as_const(*this).find(key) - items_.cbegin());
+    }
+
+    inline size_t FlatDict::count(std::string_view key) const {
+        return find(key) != items_.end() ? 1 : 0;
+    }
+
+    inline const Node& FlatDict::at(std::string_view key) const {
+        using namespace std::literals;
+        const_iterator itr = find(key);
+        if (itr == items_.end()) {
+            throw std::out_of_range("Key '"s + std::string(key) + "' not found"s);
+        }
+        return itr->second;
+    }
+
+    inline Node& FlatDict::at(std::string_view key) {
+        return const_cast<Node&>(std::as_const(*this).at(key));
+    }
+
+    inline Node& FlatDict::operator[](std::string key) {
+        return emplace(std::move(key), Node{}).first->second;
+    }
+
+    inline std::pair<FlatDict::iterator, bool> FlatDict::emplace(std::string key, Node value) {
+        // Ключи часто приходят по возрастанию (ответы строятся в алфавитном порядке): добавление в конец
+        if (items_.empty() || items_.back().first < key) {
+            items_.emplace_back(std::move(key), std::move(value));
+            return { std::prev(items_.end()), true };
+        }
+        const auto position = items_.begin() + (LowerBound(key) - items_.cbegin());
+        if (position->first == key) {
+            return { position, false };
+        }
+        return { items_.emplace(position, std::move(key), std::move(value)), true };
+    }
+
+    inline size_t FlatDict::erase(std::string_view key) {
+        const auto itr = find(key);
+        if (itr == items_.end()) {
+            return 0;
+        }
+        items_.erase(itr);
+        return 1;
+    }
+
+    inline bool operator==(const FlatDict& lhs, const FlatDict& rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    inline bool operator!=(const FlatDict& lhs, const FlatDict& rhs) {
+        return !(lhs == rhs);
+    }
+
     class Document {
     public:
         explicit Document(Node root)
             : root_(std::move(root)) {
         }
 
+        // Документ владеет ареной, из которой размещены массивы и словари root
+        Document(std::unique_ptr<Arena> arena, Node root)
+            : arena_(std::move(arena))
+            , root_(std::move(root)) {
+        }
+
+        // Строки root могут ссылаться на input, документ продлевает его жизнь
+        Document(std::shared_ptr<const std::string> input, std::unique_ptr<Arena> arena, Node root)
+            : input_(std::move(input))
+            , arena_(std::move(arena))
+            , root_(std::move(root)) {
+        }
+
+        Document(Document&&) = default;
+
+        // Старое дерево уничтожается раньше своей арены, новое переезжает вместе со своей
+        Document& operator=(Document&& other) noexcept {
+            if (this != &other) {
+                root_ = Node{};
+                input_ = std::move(other.input_);
+                arena_ = std::move(other.arena_);
+                root_ = std::move(other.root_);
+            }
+            return *this;
+        }
+
         const Node& GetRoot() const {
             return root_;
         }
 
+        // Текст, на который ссылаются строки документа, или nullptr. Владелец указателя может
+        // хранить ссылки на строки дольше самого документа, например как имена справочника
+        const std::shared_ptr<const std::string>& GetInput() const {
+            return input_;
+        }
+
     private:
+        // Объявлены раньше корня и поэтому освобождаются после него
+        std::shared_ptr<const std::string> input_;
+        std::unique_ptr<Arena> arena_;
         Node root_;
     };
 
@@ -142,8 +343,32 @@ namespace json {
         return !(lhs == rhs);
     }
 
+    // Разбор из непрерывного буфера, например из отображённого в память файла.
+    // Массивы и словари документа размещаются в его арене, строки копируются
+    Document Load(std::string_view input);
+    // То же, но строки без escape-последовательностей не копируются, а ссылаются на input
+    Document Load(std::shared_ptr<const std::string> input);
+    // Читает поток целиком и разбирает его как буфер без копирования строк
     Document Load(std::istream& input);
 
-    void Print(const Document& doc, std::ostream& output);
+    enum class Format {
+        JSON,
+        MSGPACK
+    };
+
+    struct PrintOptions {
+        // false - double как у std::ostream по умолчанию (%g, 6 значащих цифр), этого формата ждут клиенты;
+        // true - кратчайшая запись, которая читается обратно в то же значение
+        bool round_trip_doubles = false;
+        // true - без переводов строк и отступов, например для ответов с картой в десятки мегабайт
+        bool compact = false;
+        // MSGPACK - двоичная запись (json_msgpack.h), остальные настройки на неё не влияют
+        Format format = Format::JSON;
+    };
+
+    void Print(const Document& doc, std::ostream& output, const PrintOptions& options = {});
+
+    // Память дерева документа по видам узлов: массивы, словари (с ключами) и строки
+    void ReportMemory(const Document& doc, memory::MemoryReport& report, const std::string& prefix);
 
 }  // namespace json
@@ -5,49 +5,100 @@ namespace json {
 	using namespace std::literals;
 
 	Builder::Builder()
-		: root_()
-		, nodes_stack_{ &root_ }
+		: Builder(std::pmr::get_default_resource())
 	{}
 
+	Builder::Builder(std::pmr::memory_resource* resource)
+		: resource_(resource)
+		, root_()
+	{
+		PushFrame(Frame::Kind::SLOT);
+	}
+
 	Node Builder::Build() {
-		if (!nodes_stack_.empty()) {
+		if (depth_ != 0) {
 			throw std::logic_error("Attempt to build JSON which isn't finalized"s);
 		}
 		return std::move(root_);
 	}
 
-	Node::Value& Builder::GetCurrentValue() {
+	Builder::Frame& Builder::GetTopFrame() {
 
-		if (nodes_stack_.empty()) {
+		if (depth_ == 0) {
 			throw std::logic_error("Error - JSON is not finish"s);
 		}
-		return nodes_stack_.back()->GetValue();
+		return frames_[depth_ - 1];
 	}
 
-	Builder::DictItemContext Builder::StartDict() {
+	void Builder::PushFrame(Frame::Kind kind, std::string key) {
+		if (depth_ == frames_.size()) {
+			frames_.emplace_back();
+		}
+		Frame& frame = frames_[depth_++];
+		frame.kind = kind;
+		frame.key = std::move(key);
+	}
 
-		Node::Value& host_value = GetCurrentValue();
+	void Builder::PopFrame() {
+		Frame& frame = frames_[--depth_];
+		if (frame.kind == Frame::Kind::ARRAY) {
+			Array result(resource_);
+			result.reserve(frame.array_items.size());
+			for (Node& item : frame.array_items) {
+				result.push_back(std::move(item));
+			}
+			frame.array_items.clear();
+			Deliver(std::move(result));
+		}
+		else {
+			Dict result(resource_);
+			result.reserve(frame.dict_items.size());
+			for (auto& [key, value] : frame.dict_items) {
+				if (!result.emplace(std::move(key), std::move(value)).second) {
+					frame.dict_items.clear();
+					throw std::logic_error("Duplicate key in dict"s);
+				}
+			}
+			frame.dict_items.clear();
+			Deliver(std::move(result));
+		}
+	}
 
-		if (std::holds_alternative<Array>(host_value)) {
-			Node& node = std::get<Array>(host_value).emplace_back(std::move(Dict{}));
-			nodes_stack_.push_back(&node);
+	void Builder::Deliver(Node node) {
+		Frame& host = frames_[depth_ - 1];
+		if (host.kind == Frame::Kind::ARRAY) {
+			host.array_items.push_back(std::move(node));
+			return;
 		}
-		else if (std::holds_alternative<std::nullptr_t>(host_value)) {
-			host_value = Dict{};
+
+		// Значение ключа кладётся в словарь под ним, значение корня завершает построение
+		std::string key = std::move(host.key);
+		--depth_;
+		if (depth_ == 0) {
+			root_ = std::move(node);
 		}
 		else {
+			frames_[depth_ - 1].dict_items.emplace_back(std::move(key), std::move(node));
+		}
+	}
+
+	Builder::DictItemContext Builder::StartDict() {
+
+		const Frame& host = GetTopFrame();
+
+		if (host.kind == Frame::Kind::DICT) {
 			throw std::logic_error("Can not create new object"s);
 		}
+		PushFrame(Frame::Kind::DICT);
 		return DictItemContext{ *this };
 	}
-	
+
 	Builder::DictValueContext Builder::Key(std::string key) {
 
-		Node::Value& host_value = GetCurrentValue();
+		const Frame& host = GetTopFrame();
 
-		if (std::holds_alternative<Dict>(host_value)) {
-			auto& host_value = GetCurrentValue();
-			nodes_stack_.push_back(&std::get<Dict>(host_value)[std::move(key)]);
+		if (host.kind == Frame::Kind::DICT) {
+			PushFrame(Frame::Kind::SLOT, std::move(key));
 		}
 		else {
 			throw std::logic_error("Dict was not expected here"s);
@@ -57,40 +108,34 @@ namespace json {
 
 	Builder::BaseContext Builder::EndDict() {
 
-		Node::Value& host_value = GetCurrentValue();
+		const Frame& host = GetTopFrame();
 
-		if (std::holds_alternative<Dict>(host_value)) {
-			nodes_stack_.pop_back();
+		if (host.kind == Frame::Kind::DICT) {
+			PopFrame();
 			return *this;
 		}
 		else {
 			throw std::logic_error("EndDict was not expected here"s);
 		}
 	}
-	
+
 	Builder::ArrayItemContext Builder::StartArray() {
 
-		Node::Value& host_value = GetCurrentValue();
+		const Frame& host = GetTopFrame();
 
-		if (std::holds_alternative<Array>(host_value)) {
-			Node& node = std::get<Array>(host_value).emplace_back(std::move(Array{}));
-			nodes_stack_.push_back(&node);
-		}
-		else if (std::holds_alternative<std::nullptr_t>(host_value)) {
-			host_value = Array{};
-		}
-		else {
+		if (host.kind == Frame::Kind::DICT) {
 			throw std::logic_error("Can not create new object"s);
 		}
+		PushFrame(Frame::Kind::ARRAY);
 		return BaseContext{ *this };
 	}
 
 	Builder::BaseContext Builder::EndArray() {
 
-		Node::Value& host_value = GetCurrentValue();
-		
-		if (std::holds_alternative<Array>(host_value)) {
-			nodes_stack_.pop_back();
+		const Frame& host = GetTopFrame();
+
+		if (host.kind == Frame::Kind::ARRAY) {
+			PopFrame();
 			return BaseContext{ *this };
 		}
 		else {
@@ -100,19 +145,12 @@ namespace json {
 
 	Builder::BaseContext Builder::Value(Node::Value value) {
 
-		Node::Value& host_value = GetCurrentValue();
+		const Frame& host = GetTopFrame();
 
-		if (std::holds_alternative<Array>(host_value)) {
-			std::get<Array>(host_value).emplace_back(std::move(value));
-		}
-		else if (std::holds_alternative<std::nullptr_t>(host_value)) {
-			host_value = std::move(value);
-			nodes_stack_.pop_back();
-		}
-		else {
+		if (host.kind == Frame::Kind::DICT) {
 			throw std::logic_error("Input Value was not expected here"s);
 		}
+		Deliver(std::move(value));
 		return *this;
 	}
 }
-
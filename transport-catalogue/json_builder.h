@@ -1,7 +1,10 @@
 #pragma once
 #include <exception>
 #include "json.h"
+#include <memory_resource>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace json {
 
@@ -18,6 +21,8 @@ namespace json {
     public:
 
         Builder();
+        // Массивы и словари результата размещаются в resource, например в арене документа
+        explicit Builder(std::pmr::memory_resource* resource);
 
         Node Build();
 
@@ -28,8 +33,6 @@ namespace json {
         //Builder& EndArray();
         //Builder& Value(Node::Value Value);
 
-        Node::Value& GetCurrentValue();
-
         DictValueContext Key(std::string key);
         BaseContext Value(Node::Value value);
         DictItemContext StartDict();
@@ -38,8 +41,29 @@ namespace json {
         BaseContext EndArray();
 
     private:
+        // Незавершённый узел: значение корня или ключа словаря либо открытый контейнер.
+        // Элементы контейнера копятся в буфере уровня и переносятся в resource_ одним выделением
+        // при закрытии, поэтому массивы и словари не перевыделяются по мере роста
+        struct Frame {
+            enum class Kind { SLOT, ARRAY, DICT };
+
+            Kind kind = Kind::SLOT;
+            std::string key;
+            std::vector<Node> array_items;
+            std::vector<Dict::value_type> dict_items;
+        };
+
+        Frame& GetTopFrame();
+        void PushFrame(Frame::Kind kind, std::string key = {});
+        // Снимает закрытый уровень и передаёт готовый узел тому, кто его ждёт
+        void PopFrame();
+        void Deliver(Node node);
+
+        std::pmr::memory_resource* resource_;
         Node root_;
-        std::vector<Node*> nodes_stack_;
+        // Снятые уровни не удаляются, чтобы их буферы использовались повторно
+        std::vector<Frame> frames_;
+        size_t depth_ = 0;
 
 
         class BaseContext {
@@ -0,0 +1,198 @@
+#include "json_msgpack.h"
+
+#include "json_scan.h"
+
+#include <bit>
+#include <cstdio>
+#include <limits>
+
+namespace json {
+
+    namespace {
+        using namespace std::literals;
+
+        // Разбор MessagePack из непрерывного буфера; после корневого узла остаток буфера не читается.
+        // Массивы и словари размещаются в resource, при share_strings строки ссылаются на input
+        class MsgPackParser {
+        public:
+            MsgPackParser(std::string_view input, std::pmr::memory_resource* resource, bool share_strings)
+                : pos_(input.data())
+                , end_(input.data() + input.size())
+                , resource_(resource)
+                , share_strings_(share_strings) {
+            }
+
+            Node LoadNode() {
+                const uint8_t type = ReadByte();
+                if (type <= msgpack::POSITIVE_FIXINT_MAX) {
+                    return static_cast<int>(type);
+                }
+                if (type >= msgpack::NEGATIVE_FIXINT) {
+                    return static_cast<int>(static_cast<int8_t>(type));
+                }
+                if ((type & 0xf0) == msgpack::FIXMAP) {
+                    return LoadDict(type & 0x0f);
+                }
+                if ((type & 0xf0) == msgpack::FIXARRAY) {
+                    return LoadArray(type & 0x0f);
+                }
+                if ((type & 0xe0) == msgpack::FIXSTR) {
+                    return LoadString(type & 0x1f);
+                }
+
+                switch (type) {
+                case msgpack::NIL:
+                    return nullptr;
+                case msgpack::BOOL_FALSE:
+                    return false;
+                case msgpack::BOOL_TRUE:
+                    return true;
+                case msgpack::FLOAT32:
+                    return static_cast<double>(std::bit_cast<float>(static_cast<uint32_t>(ReadBigEndian(4))));
+                case msgpack::FLOAT64:
+                    return std::bit_cast<double>(ReadBigEndian(8));
+                case msgpack::UINT8:
+                    return static_cast<int>(ReadBigEndian(1));
+                case msgpack::UINT16:
+                    return static_cast<int>(ReadBigEndian(2));
+                case msgpack::UINT32:
+                    return UnsignedToNode(ReadBigEndian(4));
+                case msgpack::UINT64:
+                    return UnsignedToNode(ReadBigEndian(8));
+                case msgpack::INT8:
+                    return static_cast<int>(static_cast<int8_t>(ReadBigEndian(1)));
+                case msgpack::INT16:
+                    return static_cast<int>(static_cast<int16_t>(ReadBigEndian(2)));
+                case msgpack::INT32:
+                    return static_cast<int>(static_cast<int32_t>(ReadBigEndian(4)));
+                case msgpack::INT64:
+                    return SignedToNode(static_cast<int64_t>(ReadBigEndian(8)));
+                case msgpack::STR8:
+                    return LoadString(ReadBigEndian(1));
+                case msgpack::STR16:
+                    return LoadString(ReadBigEndian(2));
+                case msgpack::STR32:
+                    return LoadString(ReadBigEndian(4));
+                case msgpack::ARRAY16:
+                    return LoadArray(ReadBigEndian(2));
+                case msgpack::ARRAY32:
+                    return LoadArray(ReadBigEndian(4));
+                case msgpack::MAP16:
+                    return LoadDict(ReadBigEndian(2));
+                case msgpack::MAP32:
+                    return LoadDict(ReadBigEndian(4));
+                default:
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "0x%02x", type);
+                    throw ParsingError("Unsupported MessagePack type "s + code);
+                }
+            }
+
+        private:
+            uint8_t ReadByte() {
+                if (pos_ == end_) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                return static_cast<uint8_t>(*pos_++);
+            }
+
+            uint64_t ReadBigEndian(size_t bytes) {
+                if (static_cast<size_t>(end_ - pos_) < bytes) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                uint64_t value = 0;
+                for (size_t i = 0; i < bytes; ++i) {
+                    value = (value << 8) | static_cast<uint8_t>(*pos_++);
+                }
+                return value;
+            }
+
+            std::string_view ReadBytes(uint64_t size) {
+                if (static_cast<uint64_t>(end_ - pos_) < size) {
+                    throw ParsingError("String parsing error"s);
+                }
+                const std::string_view bytes(pos_, static_cast<size_t>(size));
+                pos_ += size;
+                return bytes;
+            }
+
+            // Как и в JSON, целые вне диапазона int хранятся как double
+            static Node SignedToNode(int64_t value) {
+                if (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max()) {
+                    return static_cast<int>(value);
+                }
+                return static_cast<double>(value);
+            }
+
+            static Node UnsignedToNode(uint64_t value) {
+                if (value <= static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+                    return static_cast<int>(value);
+                }
+                return static_cast<double>(value);
+            }
+
+            Node LoadString(uint64_t size) {
+                const std::string_view value = ReadBytes(size);
+                if (share_strings_) {
+                    return StringRef{ value };
+                }
+                return std::string(value);
+            }
+
+            // Каждый элемент занимает хотя бы байт, поэтому заявленный размер не больше остатка буфера
+            size_t CheckedSize(uint64_t size) const {
+                if (size > static_cast<uint64_t>(end_ - pos_)) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                return static_cast<size_t>(size);
+            }
+
+            Node LoadArray(uint64_t size) {
+                Array result(resource_);
+                result.reserve(CheckedSize(size));
+                for (uint64_t i = 0; i < size; ++i) {
+                    result.push_back(LoadNode());
+                }
+                return result;
+            }
+
+            Node LoadDict(uint64_t size) {
+                CheckedSize(size);
+                scan::DictScratch::Level& level = dict_scratch_.Open();
+                for (uint64_t i = 0; i < size; ++i) {
+                    Node key_node = LoadNode();
+                    if (!key_node.IsString()) {
+                        throw ParsingError("Dictionary key must be a string"s);
+                    }
+                    std::string key(key_node.AsString());
+                    const size_t position = level.FindPosition(key);
+                    Node value = LoadNode();
+                    level.Insert(position, std::move(key), std::move(value));
+                }
+                return dict_scratch_.Close(resource_);
+            }
+
+            const char* pos_;
+            const char* end_;
+            std::pmr::memory_resource* resource_;
+            bool share_strings_;
+            scan::DictScratch dict_scratch_;
+        };
+    }  // namespace
+
+    Document LoadMsgPack(std::string_view input) {
+        auto arena = std::make_unique<Arena>();
+        Node root = MsgPackParser(input, arena.get(), false).LoadNode();
+        return Document(std::move(arena), std::move(root));
+    }
+
+    Document LoadMsgPack(std::shared_ptr<const std::string> input) {
+        auto arena = std::make_unique<Arena>();
+        Node root = MsgPackParser(*input, arena.get(), true).LoadNode();
+        return Document(std::move(input), std::move(arena), std::move(root));
+    }
+
+    Document LoadMsgPack(std::istream& input) {
+        return LoadMsgPack(scan::ReadAll(input));
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "json.h"
+
+namespace json {
+
+    // MessagePack - двоичная запись той же модели документа, что и JSON: nil, bool, целые, числа
+    // с плавающей точкой, строки, массивы и словари со строковыми ключами. Целые, которые не помещаются
+    // в int, читаются как double, как и в JSON; bin, ext и ключи другого типа - ParsingError.
+    // Записывает MessagePack json::Writer с PrintOptions::format == Format::MSGPACK
+    namespace msgpack {
+
+        inline constexpr uint8_t POSITIVE_FIXINT_MAX = 0x7f;
+        inline constexpr uint8_t FIXMAP = 0x80;
+        inline constexpr uint8_t FIXARRAY = 0x90;
+        inline constexpr uint8_t FIXSTR = 0xa0;
+        inline constexpr uint8_t NIL = 0xc0;
+        inline constexpr uint8_t BOOL_FALSE = 0xc2;
+        inline constexpr uint8_t BOOL_TRUE = 0xc3;
+        inline constexpr uint8_t FLOAT32 = 0xca;
+        inline constexpr uint8_t FLOAT64 = 0xcb;
+        inline constexpr uint8_t UINT8 = 0xcc;
+        inline constexpr uint8_t UINT16 = 0xcd;
+        inline constexpr uint8_t UINT32 = 0xce;
+        inline constexpr uint8_t UINT64 = 0xcf;
+        inline constexpr uint8_t INT8 = 0xd0;
+        inline constexpr uint8_t INT16 = 0xd1;
+        inline constexpr uint8_t INT32 = 0xd2;
+        inline constexpr uint8_t INT64 = 0xd3;
+        inline constexpr uint8_t STR8 = 0xd9;
+        inline constexpr uint8_t STR16 = 0xda;
+        inline constexpr uint8_t STR32 = 0xdb;
+        inline constexpr uint8_t ARRAY16 = 0xdc;
+        inline constexpr uint8_t ARRAY32 = 0xdd;
+        inline constexpr uint8_t MAP16 = 0xde;
+        inline constexpr uint8_t MAP32 = 0xdf;
+        inline constexpr uint8_t NEGATIVE_FIXINT = 0xe0;
+
+        // Наибольший размер, который помещается в байт типа fixarray/fixmap и fixstr
+        inline constexpr size_t FIX_CONTAINER_MAX = 15;
+        inline constexpr size_t FIXSTR_MAX = 31;
+    }
+
+    // То же, что json::Load, но для MessagePack: массивы и словари размещаются в арене документа,
+    // строки копируются
+    Document LoadMsgPack(std::string_view input);
+    // Строки не копируются, а ссылаются на input
+    Document LoadMsgPack(std::shared_ptr<const std::string> input);
+    // Читает поток целиком и разбирает его как буфер без копирования строк
+    Document LoadMsgPack(std::istream& input);
+}
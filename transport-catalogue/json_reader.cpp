@@ -1,6 +1,111 @@
 #include "json_reader.h"
+#include <limits>
 #include <sstream>
 
+namespace {
+	// Номера полей совпадают с порядком имён в таблицах
+	enum BaseField : size_t {
+		BASE_TYPE, BASE_NAME, BASE_LATITUDE, BASE_LONGITUDE, BASE_ROAD_DISTANCES, BASE_STOPS, BASE_IS_ROUNDTRIP, BASE_FIELD_COUNT
+	};
+	constexpr json::schema::FieldTable<BASE_FIELD_COUNT> BASE_FIELDS(std::array<std::string_view, BASE_FIELD_COUNT>{
+		"type"sv, "name"sv, "latitude"sv, "longitude"sv, "road_distances"sv, "stops"sv, "is_roundtrip"sv });
+
+	enum StatField : size_t { STAT_ID, STAT_TYPE, STAT_NAME, STAT_FROM, STAT_TO, STAT_FIELD_COUNT };
+	constexpr json::schema::FieldTable<STAT_FIELD_COUNT> STAT_FIELDS(std::array<std::string_view, STAT_FIELD_COUNT>{
+		"id"sv, "type"sv, "name"sv, "from"sv, "to"sv });
+
+	constexpr uint64_t FieldBit(size_t field) {
+		return uint64_t{ 1 } << field;
+	}
+
+	constexpr uint64_t STOP_REQUIRED = FieldBit(BASE_NAME) | FieldBit(BASE_LATITUDE) | FieldBit(BASE_LONGITUDE);
+	constexpr uint64_t BUS_REQUIRED = FieldBit(BASE_NAME) | FieldBit(BASE_STOPS) | FieldBit(BASE_IS_ROUNDTRIP);
+
+	std::string_view RequiredField(const std::optional<std::string_view>& value, std::string_view field) {
+		if (!value) {
+			throw json::ParsingError("Field '"s + std::string(field) + "' is missing"s);
+		}
+		return *value;
+	}
+
+	enum class ParamType { NUMBER, INT, STRING };
+
+	// Схема параметров запроса одного типа: первые required_count полей обязательны.
+	// Параметры проверяются при разборе, ответ на запрос читает их уже без проверок
+	template <size_t N>
+	struct ParamSchema {
+		json::schema::FieldTable<N> fields;
+		std::array<ParamType, N> types;
+		size_t required_count;
+	};
+
+	constexpr ParamSchema<3> NEAREST_STOPS_PARAMS{
+		json::schema::FieldTable<3>(std::array<std::string_view, 3>{ "latitude"sv, "longitude"sv, "count"sv }),
+		{ ParamType::NUMBER, ParamType::NUMBER, ParamType::INT }, 2 };
+	constexpr ParamSchema<4> STOPS_IN_BOX_PARAMS{
+		json::schema::FieldTable<4>(std::array<std::string_view, 4>{ "min_latitude"sv, "min_longitude"sv, "max_latitude"sv, "max_longitude"sv }),
+		{ ParamType::NUMBER, ParamType::NUMBER, ParamType::NUMBER, ParamType::NUMBER }, 4 };
+	constexpr ParamSchema<2> SEARCH_PREFIX_PARAMS{
+		json::schema::FieldTable<2>(std::array<std::string_view, 2>{ "prefix"sv, "limit"sv }),
+		{ ParamType::STRING, ParamType::INT }, 1 };
+	constexpr ParamSchema<3> SEARCH_FUZZY_PARAMS{
+		json::schema::FieldTable<3>(std::array<std::string_view, 3>{ "query"sv, "limit"sv, "max_distance"sv }),
+		{ ParamType::STRING, ParamType::INT, ParamType::INT }, 1 };
+	constexpr ParamSchema<4> TOP_PARAMS{
+		json::schema::FieldTable<4>(std::array<std::string_view, 4>{ "by"sv, "min"sv, "max"sv, "count"sv }),
+		{ ParamType::STRING, ParamType::NUMBER, ParamType::NUMBER, ParamType::INT }, 1 };
+	constexpr ParamSchema<5> ROUTE_BY_POINTS_PARAMS{
+		json::schema::FieldTable<5>(std::array<std::string_view, 5>{ "from_latitude"sv, "from_longitude"sv, "to_latitude"sv, "to_longitude"sv, "count"sv }),
+		{ ParamType::NUMBER, ParamType::NUMBER, ParamType::NUMBER, ParamType::NUMBER, ParamType::INT }, 4 };
+	constexpr ParamSchema<1> ROUTES_PARAMS{
+		json::schema::FieldTable<1>(std::array<std::string_view, 1>{ "count"sv }),
+		{ ParamType::INT }, 0 };
+
+	template <size_t N>
+	void CheckParams(const Dict& params, const ParamSchema<N>& schema) {
+		uint64_t seen = 0;
+		for (const auto& [key, value] : params) {
+			const size_t field = schema.fields.Find(key);
+			if (field == schema.fields.NOT_FOUND) {
+				continue;
+			}
+			const ParamType type = schema.types[field];
+			const bool valid = type == ParamType::NUMBER ? value.IsDouble()
+				: type == ParamType::INT ? value.IsInt()
+				: value.IsString();
+			if (!valid) {
+				throw json::ParsingError("Field '"s + key + "' has unexpected type"s);
+			}
+			seen |= FieldBit(field);
+		}
+		json::schema::CheckRequired(schema.fields, seen, FieldBit(schema.required_count) - 1);
+	}
+
+	void CheckRequestParams(std::string_view type, bool route_by_points, const Dict& params) {
+		if (route_by_points) {
+			CheckParams(params, ROUTE_BY_POINTS_PARAMS);
+		}
+		else if (type == "Routes"sv) {
+			CheckParams(params, ROUTES_PARAMS);
+		}
+		else if (type == "NearestStops"sv) {
+			CheckParams(params, NEAREST_STOPS_PARAMS);
+		}
+		else if (type == "StopsInBox"sv) {
+			CheckParams(params, STOPS_IN_BOX_PARAMS);
+		}
+		else if (type == "SearchPrefix"sv) {
+			CheckParams(params, SEARCH_PREFIX_PARAMS);
+		}
+		else if (type == "SearchFuzzy"sv) {
+			CheckParams(params, SEARCH_FUZZY_PARAMS);
+		}
+		else if (type == "Top"sv) {
+			CheckParams(params, TOP_PARAMS);
+		}
+	}
+}
+
 void LoadTransportDataFromJson(TransportCatalogue& tc, TransportRouter& rt, const json::Document& doc) {
 	LoadTransportCatalogueFromJson(tc, doc);
 	LoadTransportRouterFromJson(rt, doc);
@@ -8,242 +113,763 @@ void LoadTransportDataFromJson(TransportCatalogue& tc, TransportRouter& rt, cons
 }
 
 void LoadTransportCatalogueFromJson(TransportCatalogue& tc, const json::Document& doc) {
+	// Если строки документа ссылаются на его текст, справочник берёт имена оттуда без копии
+	tc.AdoptNameBuffer(doc.GetInput());
+	LoadBaseRequests(tc, doc.GetRoot().AsDict().at("base_requests").AsArray());
+}
 
-	Dict top_dict = doc.GetRoot().AsDict();
-	Array bus_stop_desc = top_dict["base_requests"].AsArray();
-	Dict routing_seetings = top_dict["routing_settings"].AsDict();
+void LoadBaseRequests(TransportCatalogue& tc, const Array& base_requests) {
+	// Один проход по base_requests: записи ссылаются на строки документа, который живёт дольше загрузки
+	CatalogueBatch batch;
+	batch.stops.reserve(base_requests.size());
+
+	for (const auto& request : base_requests) {
+		const Dict& dict = request.AsDict();
+		const std::string_view type = dict.at("type").AsString();
+		if (type == "Stop") {
+			const std::string_view stop_name = dict.at("name").AsString();
+			batch.stops.push_back({ stop_name, { dict.at("latitude").AsDouble(), dict.at("longitude").AsDouble() } });
+			auto itr = dict.find("road_distances");
+			if (itr != dict.end()) {
+				for (const auto& [stop_next, distance] : itr->second.AsDict()) {
+					batch.distances.push_back({ stop_name, stop_next, distance.AsInt() });
+				}
+			}
+		}
+		else if (type == "Bus") {
+			const Array& stops_name = dict.at("stops").AsArray();
+			BusRecord record{ dict.at("name").AsString(), {}, dict.at("is_roundtrip").AsBool() };
+			record.stops.reserve(stops_name.size());
+			for (const auto& sn : stops_name) {
+				record.stops.push_back(sn.AsString());
+			}
+			batch.buses.push_back(move(record));
+		}
+	}
+
+	tc.AddBatch(batch);
+	tc.BuildIndexes();
+	tc.PrecomputeStatistics();
+}
 
-	LoadStops(tc,bus_stop_desc);
-	LoadStopsDistance(tc, bus_stop_desc);
-	LoadBuses(tc, bus_stop_desc);
+vector<string_view> GetBusStopsFromJson(const Dict& bus_dict) {
+	const Array& stops_name = bus_dict.at("stops").AsArray();
+	vector<string_view> stops_vec;
+	for (const auto& sn : stops_name) {
+		stops_vec.push_back(sn.AsString());
+	}
+	// Некольцевой маршрут проходится туда и обратно
+	if (!bus_dict.at("is_roundtrip").AsBool() && !stops_vec.empty()) {
+		stops_vec.insert(stops_vec.end(), next(stops_vec.rbegin()), stops_vec.rend());
+	}
+	return stops_vec;
 }
 
-void LoadStops(TransportCatalogue& tc, const Array& stop_desc) {
-	for (size_t j = 0; j < stop_desc.size(); ++j) {
-		Dict stop_dict = stop_desc[j].AsDict();
-		auto itr = stop_dict.find("type");
-		if (itr->second.AsString() == "Stop") {
-			const std::string stop_name = stop_dict.at("name").AsString();
-			Coordinates coordinates{ stop_dict.at("latitude").AsDouble(), stop_dict.at("longitude").AsDouble() };
-			tc.AddBusStop(stop_name, coordinates);
+void ApplyUpdatesFromJson(TransportCatalogue& tc, const json::Document& doc) {
+	const Dict& top_dict = doc.GetRoot().AsDict();
+	auto itr = top_dict.find("update_requests");
+	if (itr == top_dict.end()) {
+		return;
+	}
+
+	for (const auto& arr : itr->second.AsArray()) {
+		const Dict& dict = arr.AsDict();
+		const std::string_view type = dict.at("type").AsString();
+		const std::string_view name = dict.at("name").AsString();
+		if (type == "RemoveBus") {
+			tc.RemoveBus(name);
+		}
+		else if (type == "ReplaceBus") {
+			tc.ReplaceBus(name, GetBusStopsFromJson(dict), dict.at("is_roundtrip").AsBool());
+		}
+		else if (type == "MoveStop") {
+			tc.MoveStop(name, { dict.at("latitude").AsDouble(), dict.at("longitude").AsDouble() });
+		}
+		else if (type == "RemoveStop") {
+			tc.RemoveStop(name);
+		}
+		else if (type == "RenameStop") {
+			tc.RenameStop(name, dict.at("new_name").AsString());
 		}
 	}
 }
 
-void LoadStopsDistance(TransportCatalogue& tc, const Array& stop_desc) {
-	for (size_t j = 0; j < stop_desc.size(); ++j) {
-		Dict dict = stop_desc[j].AsDict();
-		auto itr = dict.find("type");
-		if (itr->second.AsString() == "Stop") {
-			auto itr_d = dict.find("road_distances");
-			if (itr_d != dict.end()) {
-				Dict dist_dict = itr_d->second.AsDict();
-				for (const auto& dist : dist_dict) {
-					const std::string stop_name = dict.at("name").AsString();
-					std::string_view stop_next = dist.first;
-					int distance = dist.second.AsInt();
-					tc.SetBusStopDistance(stop_name, stop_next, distance);
-				}
-			}
+json::Document LoadTransportCatalogueFromStream(TransportCatalogue& tc, std::istream& input) {
+	using Token = json::StreamReader::Token;
+	auto arena = std::make_unique<json::Arena>();
+	json::StreamReader reader(input, 1 << 16, arena.get());
+
+	Token token = reader.Next();
+	if (token != Token::START_DICT) {
+		Node root = reader.ReadNode(token);
+		return json::Document(std::move(arena), std::move(root));
+	}
+	Dict root(arena.get());
+	for (token = reader.Next(); token != Token::END_DICT; token = reader.Next()) {
+		std::string key = reader.GetKey();
+		if (root.find(key) != root.end()) {
+			throw json::ParsingError("Duplicate key '"s + key + "' have been found");
+		}
+		if (key == "base_requests"s) {
+			LoadBaseRequestsFromStream(tc, reader);
+			root.emplace(std::move(key), Array(arena.get()));
+		}
+		else {
+			Node value = reader.ReadNode(reader.Next());
+			root.emplace(std::move(key), std::move(value));
 		}
 	}
+	return json::Document(std::move(arena), Node(std::move(root)));
 }
 
-void LoadBuses(TransportCatalogue& tc, const Array& stop_desc) {
-	for (size_t j = 0; j < stop_desc.size(); ++j) {
-		Dict dict = stop_desc[j].AsDict();
-		auto itr = dict.find("type");
-		if (itr->second.AsString() == "Bus") {
-			const std::string bus_name = dict.at("name").AsString();
-			Array stops_name = dict.at("stops").AsArray();
-			Array tmp_stop(stops_name.begin(), stops_name.end());
+void LoadBaseRequestsFromStream(TransportCatalogue& tc, json::StreamReader& reader) {
+	using Token = json::StreamReader::Token;
+	if (reader.Next() != Token::START_ARRAY) {
+		throw json::ParsingError("base_requests is not an array"s);
+	}
 
-			if (!dict.at("is_roundtrip").AsBool()) {
-				tmp_stop.insert(tmp_stop.end(), next(stops_name.rbegin()), stops_name.rend());
+	// Имена, которые нужны до конца загрузки. Уже известные остановки ссылаются на имена справочника,
+	// копируются только имена автобусов и ещё не прочитанных остановок; deque не перемещает строки при росте
+	std::deque<std::string> names;
+	auto keep_stop_name = [&tc, &names](string_view name) -> string_view {
+		if (StopPtr stop = tc.GetBusStopInfo(name); stop != nullptr) {
+			return stop->name;
+		}
+		return names.emplace_back(name);
+	};
+
+	CatalogueBatch batch;
+	// В памяти одновременно только один объект base_requests, и он читается прямо в структуру
+	BaseRequest request;
+	for (Token token = reader.Next(); token != Token::END_ARRAY; token = reader.Next()) {
+		ReadBaseRequest(reader, token, request);
+		if (request.type == BaseRequest::Type::STOP) {
+			tc.AddBusStop(request.name, request.coordinates);
+			if (!request.road_distances.empty()) {
+				const string_view from = keep_stop_name(request.name);
+				for (const auto& [stop_next, distance] : request.road_distances) {
+					batch.distances.push_back({ from, keep_stop_name(stop_next), distance });
+				}
+			}
+		}
+		else if (request.type == BaseRequest::Type::BUS) {
+			BusRecord record{ names.emplace_back(request.name), {}, request.is_roundtrip };
+			record.stops.reserve(request.stops.size());
+			for (const auto& sn : request.stops) {
+				record.stops.push_back(keep_stop_name(sn));
 			}
+			batch.buses.push_back(move(record));
+		}
+	}
 
-			vector<string_view> stops_vec;
-			for (const auto& sn : tmp_stop) {
-				stops_vec.push_back(sn.AsString());
+	tc.AddBatch(batch);
+	tc.BuildIndexes();
+	tc.PrecomputeStatistics();
+}
+
+void ReadBaseRequest(json::StreamReader& reader, json::StreamReader::Token token, BaseRequest& request) {
+	using Token = json::StreamReader::Token;
+	if (token != Token::START_DICT) {
+		throw json::ParsingError("base_requests item is not a dict"s);
+	}
+	std::string type;
+	request.road_distances.clear();
+	request.stops.clear();
+	request.is_roundtrip = false;
+	request.extra.clear();
+	// Ошибки типов полей копятся, пока неизвестен тип объекта: объект неизвестного типа пропускается без проверок
+	json::schema::FieldErrors errors;
+
+	const uint64_t seen = json::schema::ReadObject(reader, BASE_FIELDS, [&](size_t field, const std::string& key) {
+		const std::string_view field_name = field != BASE_FIELDS.NOT_FOUND ? BASE_FIELDS.GetName(field) : std::string_view{};
+		switch (field) {
+		case BASE_TYPE: {
+			json::schema::FieldErrors type_errors;
+			json::schema::ReadValue(reader, field_name, type, type_errors);
+			type_errors.Throw();
+			break;
+		}
+		case BASE_NAME:
+			json::schema::ReadValue(reader, field_name, request.name, errors);
+			break;
+		case BASE_LATITUDE:
+			json::schema::ReadValue(reader, field_name, request.coordinates.lat, errors);
+			break;
+		case BASE_LONGITUDE:
+			json::schema::ReadValue(reader, field_name, request.coordinates.lng, errors);
+			break;
+		case BASE_ROAD_DISTANCES:
+			json::schema::ReadDict(reader, field_name, errors, [&](const std::string& stop) {
+				// Повтор ключа - та же ошибка, что при разборе дерева; список расстояний остановки невелик
+				for (const auto& item : request.road_distances) {
+					if (item.first == stop) {
+						throw json::ParsingError("Duplicate key '"s + stop + "' have been found");
+					}
+				}
+				auto& [stop_next, distance] = request.road_distances.emplace_back(stop, 0);
+				json::schema::ReadValue(reader, stop_next, distance, errors);
+			});
+			break;
+		case BASE_STOPS:
+			json::schema::ReadArray(reader, field_name, errors, [&](Token item) {
+				Node stop = reader.ReadNode(item);
+				if (!stop.IsString()) {
+					errors.Add("Field 'stops' has unexpected type"s);
+					return;
+				}
+				request.stops.emplace_back(stop.AsString());
+			});
+			break;
+		case BASE_IS_ROUNDTRIP:
+			json::schema::ReadValue(reader, field_name, request.is_roundtrip, errors);
+			break;
+		default: {
+			// Поле вне схемы читается общим разбором в дерево
+			if (request.extra.find(key) != request.extra.end()) {
+				throw json::ParsingError("Duplicate key '"s + key + "' have been found");
 			}
-			tc.AddBusRoute(bus_name, stops_vec, dict.at("is_roundtrip").AsBool());
+			std::string extra_key = key;
+			Node value = reader.ReadNode(reader.Next());
+			request.extra.emplace(std::move(extra_key), std::move(value));
 		}
+		}
+	});
+
+	json::schema::CheckRequired(BASE_FIELDS, seen, FieldBit(BASE_TYPE));
+	if (type == "Stop"sv) {
+		request.type = BaseRequest::Type::STOP;
+		errors.Throw();
+		json::schema::CheckRequired(BASE_FIELDS, seen, STOP_REQUIRED);
+	}
+	else if (type == "Bus"sv) {
+		request.type = BaseRequest::Type::BUS;
+		errors.Throw();
+		json::schema::CheckRequired(BASE_FIELDS, seen, BUS_REQUIRED);
+	}
+	else {
+		request.type = BaseRequest::Type::UNKNOWN;
+	}
+}
+
+StatRequest DecodeStatRequest(const Dict& request) {
+	StatRequest result;
+	uint64_t seen = 0;
+	for (const auto& [key, value] : request) {
+		const size_t field = STAT_FIELDS.Find(key);
+		switch (field) {
+		case STAT_ID:
+			result.id = value.AsInt();
+			break;
+		case STAT_TYPE:
+			result.type = value.AsString();
+			break;
+		case STAT_NAME:
+			result.name = value.AsString();
+			break;
+		case STAT_FROM:
+			result.from = value.AsString();
+			break;
+		case STAT_TO:
+			result.to = value.AsString();
+			break;
+		default:
+			// Ключи словаря идут по возрастанию, поэтому params заполняется добавлением в конец
+			result.params.emplace(key, value);
+			continue;
+		}
+		seen |= FieldBit(field);
 	}
+	json::schema::CheckRequired(STAT_FIELDS, seen, FieldBit(STAT_ID) | FieldBit(STAT_TYPE));
+	return result;
 }
 
 void LoadTransportRouterFromJson(TransportRouter& rt, const json::Document& doc) {
-	Dict top_dict = doc.GetRoot().AsDict();
-	Dict rout_set = top_dict["routing_settings"].AsDict();
+	LoadRoutingSettings(rt, doc.GetRoot().AsDict().at("routing_settings").AsDict());
+}
+
+void LoadRoutingSettings(TransportRouter& rt, const Dict& rout_set) {
 	rt.SetRoutingSettings(rout_set.at("bus_wait_time").AsInt(), rout_set.at("bus_velocity").AsInt());
+	auto radius = rout_set.find("walk_radius");
+	auto velocity = rout_set.find("walk_velocity");
+	if (radius != rout_set.end() && velocity != rout_set.end()) {
+		rt.SetWalkSettings(radius->second.AsDouble(), velocity->second.AsDouble());
+	}
 }
 
 void AddStatisticsRequestFromJson(RequestHandler& rh, const json::Document& doc) {
-	Dict top_dict = doc.GetRoot().AsDict();
-	Array stat_desc = top_dict["stat_requests"].AsArray();
-
-	if (!stat_desc.empty()) {
-		for (const auto& arr : stat_desc) {
-			Dict dict = arr.AsDict();
-			if (dict["type"].AsString() == "Bus" || dict["type"].AsString() == "Stop") {
-				std::tuple<int, std::string, std::string> stat_tuple{ dict["id"].AsInt(), dict["type"].AsString(), dict["name"].AsString() };
-				rh.AddStatisticsRequest(stat_tuple);
-			}
-			else if (dict["type"].AsString() == "Route") {
-				std::tuple<int, std::string, std::string> stat_tuple{ dict["id"].AsInt(), dict["type"].AsString(),  dict["from"].AsString()};
-				rh.AddStatisticsRequest(stat_tuple);
-				rh.AddStopTo(dict["id"].AsInt(), dict["to"].AsString());
-			}
-			else {
-				std::tuple<int, std::string, std::string> stat_tuple{ dict["id"].AsInt(), dict["type"].AsString(), "" };
-				rh.AddStatisticsRequest(stat_tuple);
-			}
-		}
+	const Array& stat_desc = doc.GetRoot().AsDict().at("stat_requests").AsArray();
+
+	for (const auto& arr : stat_desc) {
+		AddStatisticsRequestFromJson(rh, arr.AsDict());
+	}
+}
+
+void AddStatisticsRequestFromJson(RequestHandler& rh, const Dict& dict) {
+	StatRequest request = DecodeStatRequest(dict);
+	const std::string_view type = request.type;
+	// Маршрут между точками: имени остановки нет, координаты берутся из параметров запроса
+	const bool route_by_points = type == "Route"sv && !request.from;
+	const bool route_by_stops = !route_by_points && (type == "Route"sv || type == "Routes"sv);
+
+	CheckRequestParams(type, route_by_points, request.params);
+
+	std::string name;
+	if (type == "Bus"sv || type == "Stop"sv) {
+		name = RequiredField(request.name, "name"sv);
+	}
+	else if (route_by_stops) {
+		name = RequiredField(request.from, "from"sv);
+	}
+	std::tuple<int, std::string, std::string> stat_tuple{ request.id, std::string(type), std::move(name) };
+	rh.AddStatisticsRequest(stat_tuple);
+
+	if (route_by_stops) {
+		rh.AddStopTo(request.id, std::string(RequiredField(request.to, "to"sv)));
+	}
+	// Обработчику нужны только поля вне общей схемы запроса
+	if (route_by_points || type == "Routes"sv || type == "NearestStops"sv || type == "StopsInBox"sv
+		|| type == "SearchPrefix"sv || type == "SearchFuzzy"sv || type == "Top"sv) {
+		rh.AddRequestParams(request.id, std::move(request.params));
 	}
 }
 
-void PrintAnswerToJson(RequestHandler& rh, std::ostream& output) {
+void PrintAnswerToJson(RequestHandler& rh, std::ostream& output, const json::PrintOptions& options) {
 	
 	int count_req = rh.GetCountStatisticsRequest();
 	if (count_req == 0) {
 		return;
 	}
 
-	json::Builder jb = json::Builder();
-	jb.StartArray();
+	// Ответы выводятся по мере вычисления, без дерева всего ответа
+	json::Writer jw(output, options);
+	jw.StartArray(static_cast<size_t>(count_req));
 
 	for (int j = 0; j < count_req; ++j) {
-		int id;
-		std::string type;
-		std::string name;
-		std::tie(id, type, name) = rh.GetRequestByNumber(j);
-		if (type == "Stop"s) {
-			jb.Value(GetAnswerBusesByStop(rh, id, name).GetValue());
-		}
-		else if (type == "Bus"s) {
-			jb.Value(GetAnswerBusStatistics(rh, id, name).GetValue());
-		}
-		else if (type == "Route"s) {
-
-			jb.Value(GetAnswerRoute(rh.GetTransportRouter(), id, name, rh.GetStopToById(id)).GetValue());
-		}
-		else {
-			jb.Value(GetAnswerSvgMap(rh, id).GetValue());
-		}
+		WriteAnswerByNumber(jw, rh, j);
 	}
-	jb.EndArray();
-	json::Document doc(jb.Build());
-	Print(doc, output);
+	jw.EndArray().Finish();
 }
 
-Node GetAnswerBusesByStop(const RequestHandler& rh, const int id, const std::string& name) {
-
-	json::Builder jb = json::Builder();
-	if (rh.GetStopBusByName(name) == nullptr) {
-		return jb.StartDict().Key("request_id").Value(id).Key("error_message").Value("not found"s).EndDict().Build();
+void WriteAnswerByNumber(json::Writer& jw, const RequestHandler& rh, int number) {
+	int id;
+	std::string type;
+	std::string name;
+	std::tie(id, type, name) = rh.GetRequestByNumber(number);
+	if (type == "Stop"s) {
+		WriteAnswerBusesByStop(jw, rh, id, name);
+	}
+	else if (type == "Bus"s) {
+		WriteAnswerBusStatistics(jw, rh, id, name);
+	}
+	else if (type == "Route"s && name.empty()) {
+		WriteAnswerRouteByPoints(jw, rh, id);
 	}
+	else if (type == "Route"s) {
+		WriteAnswerRoute(jw, rh.GetTransportRouter(), id, name, rh.GetStopToById(id));
+	}
+	else if (type == "Routes"s) {
+		WriteAnswerRoutes(jw, rh, id, name, rh.GetStopToById(id));
+	}
+	else if (type == "NearestStops"s) {
+		WriteAnswerNearestStops(jw, rh, id);
+	}
+	else if (type == "StopsInBox"s) {
+		WriteAnswerStopsInBox(jw, rh, id);
+	}
+	else if (type == "Top"s) {
+		WriteAnswerTop(jw, rh, id);
+	}
+	else if (type == "Stats"s) {
+		WriteAnswerMemoryStats(jw, rh, id);
+	}
+	else if (type == "SearchPrefix"s || type == "SearchFuzzy"s) {
+		WriteAnswerSearchNames(jw, rh, id, type == "SearchFuzzy"s);
+	}
+	else {
+		WriteAnswerSvgMap(jw, rh, id);
+	}
+}
 
-	jb.StartDict().Key("buses").StartArray();
+void WriteAnswerNotFound(json::Writer& jw, const int id) {
+	jw.StartDict().Key("error_message").Value("not found"sv).Key("request_id").Value(id).EndDict();
+}
 
-	const std::vector<BusPtr>* ptr_buses = std::move(rh.GetBusesByStop(name));
-	if (ptr_buses != nullptr) {
-		vector<BusPtr> buses(ptr_buses->begin(), ptr_buses->end());
+void WriteAnswerBusesByStop(json::Writer& jw, const RequestHandler& rh, const int id, const std::string& name) {
 
-		std::sort(buses.begin(), buses.end(), [](BusPtr lhs, BusPtr rhs) {return lhs->name < rhs->name;});
+	if (rh.GetStopBusByName(name) == nullptr) {
+		WriteAnswerNotFound(jw, id);
+		return;
+	}
 
+	jw.StartDict().Key("buses").StartArray();
 
-		for (BusPtr ptrbus : buses) {
-			jb.Value(ptrbus->name);
-		}
+	for (BusPtr ptrbus : rh.GetBusesByStop(name)) {
+		jw.Value(ptrbus->name);
 	}
-	jb.EndArray().Key("request_id").Value(id).EndDict();
-	delete ptr_buses;
-
-	return jb.Build();
+	jw.EndArray().Key("request_id").Value(id).EndDict();
 }
 
-Node GetAnswerBusStatistics(const RequestHandler& rh, const int id, const std::string& name) {
+void WriteAnswerBusStatistics(json::Writer& jw, const RequestHandler& rh, const int id, const std::string& name) {
 	std::optional<BusStat> busstat = rh.GetBusStat(name);
 
-	json::Builder jb = json::Builder();
-
 	if (!busstat.has_value()) {
-		jb.StartDict().Key("request_id"s).Value(id).Key("error_message").Value("not found"s).EndDict();
+		WriteAnswerNotFound(jw, id);
 	}
 	else {
-		jb.StartDict().Key("curvature").Value(busstat.value().curvature).Key("request_id").Value(id)
+		jw.StartDict().Key("curvature").Value(busstat.value().curvature).Key("request_id").Value(id)
 			.Key("route_length").Value(busstat.value().distance).Key("stop_count").Value(static_cast<int>(busstat.value().count_stopbus))
 			.Key("unique_stop_count").Value(static_cast<int>(busstat.value().uniq_stopbus)).EndDict();
 	}
+}
 
-	return jb.Build();
+void WriteAnswerRoute(json::Writer& jw, const TransportRouter& rt, const int id, const std::string& from, const std::string& to) {
+	WriteAnswerRouteInfo(jw, rt.GetGraphRoute(from, to), id);
 }
 
-Node GetAnswerRoute(const TransportRouter& rt, const int id, const std::string& from, const std::string& to) {
-	//json::Builder jb = json::Builder();
-	std::optional<RouterInfo> optim_route = rt.GetGraphRoute(from, to);
+void WriteAnswerRouteByPoints(json::Writer& jw, const RequestHandler& rh, const int id) {
+	const Dict& params = rh.GetRequestParamsById(id);
+	Coordinates from{ params.at("from_latitude").AsDouble(), params.at("from_longitude").AsDouble() };
+	Coordinates to{ params.at("to_latitude").AsDouble(), params.at("to_longitude").AsDouble() };
+	auto itr = params.find("count");
+	size_t count = itr != params.end() && itr->second.AsInt() > 0 ? static_cast<size_t>(itr->second.AsInt()) : 3;
+
+	WriteAnswerRouteInfo(jw, rh.GetTransportRouter().GetGraphRoute(from, to, count), id);
+}
 
-	json::Builder jb = json::Builder();
+void WriteAnswerRouteInfo(json::Writer& jw, const std::optional<RouterInfo>& optim_route, const int id) {
 
 	if (!optim_route.has_value()) {
-		return jb.StartDict().Key("request_id").Value(id).Key("error_message").Value("not found"s).EndDict().Build();
+		WriteAnswerNotFound(jw, id);
+		return;
 	}
 
-	jb.StartDict().Key("request_id").Value(id).Key("total_time").Value(optim_route.value().weight);
-	jb.Key("items").StartArray();
+	jw.StartDict();
+	AddRouteItems(jw, optim_route.value());
+	jw.Key("request_id").Value(id).Key("total_time").Value(optim_route.value().weight).EndDict();
+}
+
+void WriteAnswerRoutes(json::Writer& jw, const RequestHandler& rh, const int id, const std::string& from, const std::string& to) {
+	const Dict& params = rh.GetRequestParamsById(id);
+	auto itr = params.find("count");
+	size_t count = itr != params.end() && itr->second.AsInt() > 0 ? static_cast<size_t>(itr->second.AsInt()) : 3;
+	std::vector<RouterInfo> routes = rh.GetTransportRouter().GetGraphRoutes(from, to, count);
 
-	for (size_t i = 0; i < optim_route.value().edges.size(); ++i) {
-		EdgeInfo edge_info = optim_route.value().edges[i];
+	if (routes.empty()) {
+		WriteAnswerNotFound(jw, id);
+		return;
+	}
 
-		if (std::holds_alternative<WaitEdgeInfo>(optim_route.value().edges[i])) {
-		  //jb.StartDict().Key("type").Value("Wait").Key("stop_name").Value(std::get<WaitEdgeInfo>(rt.GetEdges()[id]).stop_ptr->name).Key("time").Value(edge.weight).EndDict();
-			jb.StartDict().Key("type").Value("Wait").Key("stop_name").Value(std::get<WaitEdgeInfo>(edge_info).stop_ptr->name).Key("time").Value(optim_route.value().edges_weight[i]).EndDict();
+	jw.StartDict().Key("request_id").Value(id).Key("routes").StartArray();
+	for (const RouterInfo& route : routes) {
+		jw.StartDict();
+		AddRouteItems(jw, route);
+		jw.Key("total_time").Value(route.weight).EndDict();
+	}
+	jw.EndArray().EndDict();
+}
+
+void AddRouteItems(json::Writer& jw, const RouterInfo& route) {
+	jw.Key("items").StartArray();
+
+	for (size_t i = 0; i < route.edges.size(); ++i) {
+		const EdgeInfo& edge_info = route.edges[i];
+
+		if (std::holds_alternative<WaitEdgeInfo>(edge_info)) {
+			jw.StartDict().Key("stop_name").Value(std::get<WaitEdgeInfo>(edge_info).stop_ptr->name).Key("time").Value(route.edges_weight[i]).Key("type").Value("Wait"sv).EndDict();
+		}
+		else if (std::holds_alternative<WalkEdgeInfo>(edge_info)) {
+			// Переход из начальной точки маршрута или в конечную не имеет остановки с одной из сторон
+			const WalkEdgeInfo& walk = std::get<WalkEdgeInfo>(edge_info);
+			jw.StartDict();
+			if (walk.from != nullptr) {
+				jw.Key("from").Value(walk.from->name);
+			}
+			jw.Key("time").Value(route.edges_weight[i]);
+			if (walk.to != nullptr) {
+				jw.Key("to").Value(walk.to->name);
+			}
+			jw.Key("type").Value("Walk"sv).EndDict();
 		}
 		else {
-			jb.StartDict().Key("type").Value("Bus").Key("bus").Value(std::get<BusEdgeInfo>(edge_info).bus_ptr->name).Key("span_count").Value(std::get<BusEdgeInfo>(edge_info).span_count).Key("time").Value(optim_route.value().edges_weight[i]).EndDict();
+			jw.StartDict().Key("bus").Value(std::get<BusEdgeInfo>(edge_info).bus_ptr->name).Key("span_count").Value(std::get<BusEdgeInfo>(edge_info).span_count).Key("time").Value(route.edges_weight[i]).Key("type").Value("Bus"sv).EndDict();
 		}
 	}
 
-	jb.EndArray().EndDict();
-
-	return jb.Build();
+	jw.EndArray();
 }
 
-Node GetAnswerSvgMap(const RequestHandler& rh, const int id) {
+void WriteAnswerSvgMap(json::Writer& jw, const RequestHandler& rh, const int id) {
 	
 	svg::Document doc = rh.RenderMap();
 	std::ostringstream s_out;
 	doc.Render(s_out);
-	std::string print_str;
-	print_str = s_out.str();
 
-	json::Builder jb = json::Builder();
-	jb.StartDict().Key("map").Value(print_str).Key("request_id").Value(id).EndDict();
+	jw.StartDict().Key("map").Value(s_out.view()).Key("request_id").Value(id).EndDict();
+}
+
+void WriteAnswerNearestStops(json::Writer& jw, const RequestHandler& rh, const int id) {
+	const Dict& params = rh.GetRequestParamsById(id);
+	Coordinates point{ params.at("latitude").AsDouble(), params.at("longitude").AsDouble() };
+	auto itr = params.find("count");
+	size_t count = itr != params.end() && itr->second.AsInt() > 0 ? static_cast<size_t>(itr->second.AsInt()) : 1;
+
+	jw.StartDict().Key("request_id").Value(id).Key("stops").StartArray();
+	for (const auto& [stop, distance] : rh.GetNearestStops(point, count)) {
+		jw.StartDict().Key("distance").Value(distance).Key("name").Value(stop->name).EndDict();
+	}
+	jw.EndArray().EndDict();
+}
+
+void WriteAnswerStopsInBox(json::Writer& jw, const RequestHandler& rh, const int id) {
+	const Dict& params = rh.GetRequestParamsById(id);
+	Coordinates min{ params.at("min_latitude").AsDouble(), params.at("min_longitude").AsDouble() };
+	Coordinates max{ params.at("max_latitude").AsDouble(), params.at("max_longitude").AsDouble() };
+
+	jw.StartDict().Key("request_id").Value(id).Key("stops").StartArray();
+	for (StopPtr stop : rh.GetStopsInBox(min, max)) {
+		jw.Value(stop->name);
+	}
+	jw.EndArray().EndDict();
+}
+
+namespace {
+	// В JSON выводится только int: большие счётчики выводятся как double
+	json::Writer::Scalar SizeToScalar(size_t value) {
+		if (value <= static_cast<size_t>(std::numeric_limits<int>::max())) {
+			return static_cast<int>(value);
+		}
+		return static_cast<double>(value);
+	}
+}
+
+void WriteAnswerTop(json::Writer& jw, const RequestHandler& rh, const int id) {
+	using BusRanking = TransportCatalogue::BusRanking;
+	static const std::unordered_map<std::string_view, BusRanking> bus_rankings = {
+		{ "curvature"sv, BusRanking::CURVATURE },
+		{ "route_length"sv, BusRanking::ROUTE_LENGTH },
+		{ "stop_count"sv, BusRanking::STOP_COUNT }
+	};
+
+	const Dict& params = rh.GetRequestParamsById(id);
+	const std::string_view by = params.at("by").AsString();
+	auto min_itr = params.find("min");
+	auto max_itr = params.find("max");
+	const bool is_range = min_itr != params.end() || max_itr != params.end();
+	const double min = min_itr != params.end() ? min_itr->second.AsDouble() : std::numeric_limits<double>::lowest();
+	const double max = max_itr != params.end() ? max_itr->second.AsDouble() : std::numeric_limits<double>::max();
+	// Без диапазона по умолчанию выдаются первые 10 записей, с диапазоном - все записи из него
+	auto count_itr = params.find("count");
+	const size_t count = count_itr != params.end() && count_itr->second.AsInt() > 0
+		? static_cast<size_t>(count_itr->second.AsInt())
+		: (is_range ? std::numeric_limits<size_t>::max() : 10);
+
+	const TransportCatalogue& tc = rh.GetTransportCatalogue();
+	jw.StartDict();
+
+	auto add_items = [&jw](const auto& ranked) {
+		jw.Key("items").StartArray();
+		for (const auto& [item, value] : ranked) {
+			jw.StartDict().Key("name").Value(item->name).Key("value").Value(value).EndDict();
+		}
+		jw.EndArray();
+	};
+
+	if (by == "bus_count"s) {
+		add_items(is_range ? tc.GetStopsInRange(min, max, count) : tc.GetTopStops(count));
+	}
+	else if (auto itr = bus_rankings.find(by); itr != bus_rankings.end()) {
+		add_items(is_range ? tc.GetBusesInRange(itr->second, min, max, count) : tc.GetTopBuses(itr->second, count));
+	}
+	else {
+		jw.Key("error_message").Value("unknown ranking"sv);
+	}
+	jw.Key("request_id").Value(id).EndDict();
+}
+
+void WriteAnswerMemoryStats(json::Writer& jw, const RequestHandler& rh, const int id) {
+	memory::MemoryReport report;
+	rh.ReportMemory(report);
+
+	jw.StartDict().Key("items").StartArray();
+	for (const memory::MemoryUsage& item : report.GetItems()) {
+		jw.StartDict()
+			.Key("bytes").Value(SizeToScalar(item.bytes))
+			.Key("count").Value(SizeToScalar(item.count))
+			.Key("name").Value(item.name)
+			.EndDict();
+	}
+	jw.EndArray()
+		.Key("request_id").Value(id)
+		.Key("total_bytes").Value(SizeToScalar(report.GetTotalBytes()))
+		.EndDict();
+}
+
+void WriteAnswerSearchNames(json::Writer& jw, const RequestHandler& rh, const int id, bool fuzzy) {
+	const Dict& params = rh.GetRequestParamsById(id);
+	auto itr = params.find("limit");
+	const size_t limit = itr != params.end() && itr->second.AsInt() > 0 ? static_cast<size_t>(itr->second.AsInt()) : 10;
+
+	vector<NameSearchIndex::Match> matches;
+	if (fuzzy) {
+		itr = params.find("max_distance");
+		// max_distance 0 - поиск только точных совпадений
+		const size_t max_distance = itr != params.end() && itr->second.AsInt() >= 0 ? static_cast<size_t>(itr->second.AsInt()) : 1;
+		matches = rh.SearchNamesFuzzy(params.at("query").AsString(), max_distance, limit);
+	}
+	else {
+		matches = rh.SearchNamesByPrefix(params.at("prefix").AsString(), limit);
+	}
+
+	jw.StartDict().Key("items").StartArray();
+	for (const auto& match : matches) {
+		jw.StartDict();
+		if (fuzzy) {
+			jw.Key("distance").Value(static_cast<int>(match.distance));
+		}
+		jw.Key("name").Value(match.entry->name)
+			.Key("type").Value(match.entry->kind == NameSearchIndex::Kind::STOP ? "Stop"sv : "Bus"sv)
+			.Key("weight").Value(static_cast<int>(match.entry->weight))
+			.EndDict();
+	}
+	jw.EndArray().Key("request_id").Value(id).EndDict();
+}
+
+void LoadPartitionedCatalogueFromJson(PartitionedCatalogue& pc, const json::Document& doc) {
+	const Dict& top_dict = doc.GetRoot().AsDict();
+	MapRenderer renderer;
+	LoadRendererSettingFromJson(renderer, doc);
+	pc.SetMapSettings(renderer.GetSharedMapSettings());
+
+	const Array& regions = top_dict.at("regions").AsArray();
+	for (const auto& region : regions) {
+		const Dict& dict = region.AsDict();
+		auto itr = dict.find("name_prefix");
+		pc.AddRegion(std::string(dict.at("id").AsString()), itr != dict.end() ? std::string(itr->second.AsString()) : ""s);
+	}
+
+	pc.BuildAll([&](PartitionedCatalogue::RegionId region, CatalogueSnapshot& snapshot) {
+		const Dict& dict = regions[region].AsDict();
+		snapshot.catalogue.AdoptNameBuffer(doc.GetInput());
+		LoadBaseRequests(snapshot.catalogue, dict.at("base_requests").AsArray());
+		// Настройки маршрутов региона переопределяют общие
+		auto itr = dict.find("routing_settings");
+		LoadRoutingSettings(snapshot.router, itr != dict.end() ? itr->second.AsDict() : top_dict.at("routing_settings").AsDict());
+		});
+}
+
+std::optional<PartitionedCatalogue::RegionId> FindRequestRegion(const PartitionedCatalogue& pc, const Dict& request) {
+	auto itr = request.find("region");
+	if (itr != request.end()) {
+		return pc.FindRegion(itr->second.AsString());
+	}
+	// Без явного региона запрос уходит в регион по префиксу имени, которое в нём указано
+	for (const char* key : { "name", "from", "prefix", "query" }) {
+		itr = request.find(key);
+		if (itr != request.end()) {
+			return pc.FindRegionByName(itr->second.AsString());
+		}
+	}
+	return pc.FindRegionByName("");
+}
+
+void PrintPartitionedAnswerToJson(const PartitionedCatalogue& pc, const json::Document& doc, std::ostream& output, const json::PrintOptions& options) {
+	const Array& stat_desc = doc.GetRoot().AsDict().at("stat_requests").AsArray();
+	if (stat_desc.empty()) {
+		return;
+	}
+
+	// Версия региона закрепляется при первом обращении к нему и держится до конца ответа
+	vector<SnapshotStore::Handle> pinned(pc.GetRegionCount());
+	vector<std::unique_ptr<RequestHandler>> handlers(pc.GetRegionCount());
+
+	json::Writer jw(output, options);
+	jw.StartArray(stat_desc.size());
+	for (const auto& request : stat_desc) {
+		const Dict& dict = request.AsDict();
+		std::optional<PartitionedCatalogue::RegionId> region = FindRequestRegion(pc, dict);
+		if (!region) {
+			WriteAnswerNotFound(jw, dict.at("id").AsInt());
+			continue;
+		}
+		if (!handlers[*region]) {
+			pinned[*region] = pc.Pin(*region);
+			handlers[*region] = std::make_unique<RequestHandler>(*pinned[*region]);
+			handlers[*region]->SetInputDocument(doc);
+		}
+		RequestHandler& rh = *handlers[*region];
+		AddStatisticsRequestFromJson(rh, dict);
+		WriteAnswerByNumber(jw, rh, rh.GetCountStatisticsRequest() - 1);
+	}
+	jw.EndArray().Finish();
+}
+
+void PrintImageAnswerToJson(const CatalogueImage& image, const json::Document& doc, std::ostream& output, const json::PrintOptions& options) {
+	const Dict& top_dict = doc.GetRoot().AsDict();
+	auto itr = top_dict.find("stat_requests");
+	if (itr == top_dict.end() || itr->second.AsArray().empty()) {
+		return;
+	}
+
+	json::Writer jw(output, options);
+	jw.StartArray(itr->second.AsArray().size());
+
+	for (const auto& request : itr->second.AsArray()) {
+		const Dict& dict = request.AsDict();
+		const int id = dict.at("id").AsInt();
+		const std::string_view type = dict.at("type").AsString();
+
+		if (type == "Bus"s) {
+			std::optional<BusStatistic> busstat = image.GetRouteStatistic(dict.at("name").AsString());
+			if (!busstat.has_value()) {
+				WriteAnswerNotFound(jw, id);
+				continue;
+			}
+			jw.StartDict().Key("curvature").Value(busstat->curvature).Key("request_id").Value(id)
+				.Key("route_length").Value(busstat->distance).Key("stop_count").Value(static_cast<int>(busstat->count_stopbus))
+				.Key("unique_stop_count").Value(static_cast<int>(busstat->uniq_stopbus)).EndDict();
+		}
+		else if (type == "Stop"s) {
+			std::optional<CatalogueImage::StopId> stop = image.FindStop(dict.at("name").AsString());
+			if (!stop.has_value()) {
+				WriteAnswerNotFound(jw, id);
+				continue;
+			}
+			jw.StartDict().Key("buses").StartArray();
+			for (CatalogueImage::BusId bus : image.GetBusesByStop(*stop)) {
+				jw.Value(image.GetBusName(bus));
+			}
+			jw.EndArray().Key("request_id").Value(id).EndDict();
+		}
+		else {
+			// Маршруты и карта требуют графа и настроек отрисовки, которых в образе нет
+			jw.StartDict().Key("error_message").Value("not supported"sv).Key("request_id").Value(id).EndDict();
+		}
+	}
 
-	return jb.Build();
+	jw.EndArray().Finish();
 }
 
 void LoadRendererSettingFromJson(MapRenderer& mr, const json::Document& doc) {
-	Dict top_dict = doc.GetRoot().AsDict();
-	Dict render_settings = top_dict["render_settings"].AsDict();
+	const Dict& render_settings = doc.GetRoot().AsDict().at("render_settings").AsDict();
 	MapSettings map_settings;
 
-	map_settings.wight = render_settings["width"].AsDouble();
-	map_settings.height = render_settings["height"].AsDouble();
-	map_settings.padding = render_settings["padding"].AsDouble();
-	map_settings.stop_radius = render_settings["stop_radius"].AsDouble();
-	map_settings.line_width = render_settings["line_width"].AsDouble();
-	map_settings.bus_label_font_size = render_settings["bus_label_font_size"].AsInt();
-	map_settings.bus_label_offset[0] = render_settings["bus_label_offset"].AsArray()[0].AsDouble();
-	map_settings.bus_label_offset[1] = render_settings["bus_label_offset"].AsArray()[1].AsDouble();
-	map_settings.stop_label_font_size = render_settings["stop_label_font_size"].AsInt();
-	map_settings.stop_label_offset[0] = render_settings["stop_label_offset"].AsArray()[0].AsDouble();
-	map_settings.stop_label_offset[1] = render_settings["stop_label_offset"].AsArray()[1].AsDouble();
-	map_settings.underlayer_color = mr.GetColorFromJsonNode(render_settings["underlayer_color"]);
-	map_settings.underlayer_width = render_settings["underlayer_width"].AsDouble();
+	map_settings.wight = render_settings.at("width").AsDouble();
+	map_settings.height = render_settings.at("height").AsDouble();
+	map_settings.padding = render_settings.at("padding").AsDouble();
+	map_settings.stop_radius = render_settings.at("stop_radius").AsDouble();
+	map_settings.line_width = render_settings.at("line_width").AsDouble();
+	map_settings.bus_label_font_size = render_settings.at("bus_label_font_size").AsInt();
+	map_settings.bus_label_offset[0] = render_settings.at("bus_label_offset").AsArray()[0].AsDouble();
+	map_settings.bus_label_offset[1] = render_settings.at("bus_label_offset").AsArray()[1].AsDouble();
+	map_settings.stop_label_font_size = render_settings.at("stop_label_font_size").AsInt();
+	map_settings.stop_label_offset[0] = render_settings.at("stop_label_offset").AsArray()[0].AsDouble();
+	map_settings.stop_label_offset[1] = render_settings.at("stop_label_offset").AsArray()[1].AsDouble();
+	map_settings.underlayer_color = mr.GetColorFromJsonNode(render_settings.at("underlayer_color"));
+	map_settings.underlayer_width = render_settings.at("underlayer_width").AsDouble();
 
 	map_settings.color_palette.clear();
 
-	for (const auto& node : render_settings["color_palette"].AsArray()) {
+	for (const auto& node : render_settings.at("color_palette").AsArray()) {
 		map_settings.color_palette.push_back(mr.GetColorFromJsonNode(node));
 	}
 
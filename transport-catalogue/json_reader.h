@@ -1,7 +1,14 @@
 #pragma once
 #include "json_builder.h"
+#include "json_writer.h"
 #include "transport_router.h"
 #include "request_handler.h"
+#include "catalogue_image.h"
+#include "partitioned_catalogue.h"
+#include "json_stream.h"
+#include "json_schema.h"
+#include <deque>
+#include <optional>
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
@@ -17,15 +24,73 @@ using namespace json;
 //using namespace std::literals;
 
 void LoadTransportCatalogueFromJson(TransportCatalogue& tc, const json::Document& doc);
+void LoadBaseRequests(TransportCatalogue& tc, const Array& base_requests);
+// Потоковая загрузка: объекты base_requests добавляются в справочник по мере чтения, без дерева документа;
+// расстояния и маршруты разрешаются после того, как прочитаны все остановки.
+// Возвращает документ с остальными секциями, base_requests в нём - пустой массив
+json::Document LoadTransportCatalogueFromStream(TransportCatalogue& tc, std::istream& input);
+void LoadBaseRequestsFromStream(TransportCatalogue& tc, json::StreamReader& reader);
+
+// Объект base_requests, разобранный по схеме. Один экземпляр переиспользуется для всех объектов,
+// поэтому строки и векторы не выделяют память заново на каждый
+struct BaseRequest {
+	enum class Type { UNKNOWN, STOP, BUS };
+	Type type = Type::UNKNOWN;
+	std::string name;
+	Coordinates coordinates;
+	std::vector<std::pair<std::string, int>> road_distances;
+	std::vector<std::string> stops;
+	bool is_roundtrip = false;
+	// Поля вне схемы в виде дерева; справочнику они не нужны
+	json::Dict extra;
+};
+// Читает объект, который начался событием token, прямо из потока: обязательные поля остановки -
+// name, latitude, longitude; маршрута - name, stops, is_roundtrip. Объект с другим type
+// дочитывается и получает Type::UNKNOWN
+void ReadBaseRequest(json::StreamReader& reader, json::StreamReader::Token token, BaseRequest& request);
+
+// Запрос stat_requests: поля, общие для всех типов, и остальные параметры запроса
+struct StatRequest {
+	int id = 0;
+	std::string_view type;
+	std::optional<std::string_view> name;
+	std::optional<std::string_view> from;
+	std::optional<std::string_view> to;
+	json::Dict params;
+};
+// Один проход по словарю запроса; строки ссылаются на его узлы
+StatRequest DecodeStatRequest(const Dict& request);
+void LoadRoutingSettings(TransportRouter& rt, const Dict& routing_settings);
 void AddStatisticsRequestFromJson(RequestHandler& rh, const json::Document& doc);
-void PrintAnswerToJson(RequestHandler& rh, std::ostream& output);
-Node GetAnswerBusStatistics(const RequestHandler& rh, const int id, const std::string& name);
-Node GetAnswerBusesByStop(const RequestHandler& rh, const int id, const std::string& name);
-Node GetAnswerRoute(const TransportRouter& rt, const int id, const std::string& from, const std::string& to);
-Node GetAnswerSvgMap(const RequestHandler& rh, const int id);
+void AddStatisticsRequestFromJson(RequestHandler& rh, const Dict& request);
+void PrintAnswerToJson(RequestHandler& rh, std::ostream& output, const json::PrintOptions& options = {});
+// Ответ на запрос с порядковым номером number среди добавленных в обработчик.
+// Ответы записываются сразу в jw, ключи словарей - в порядке возрастания
+void WriteAnswerByNumber(json::Writer& jw, const RequestHandler& rh, int number);
+void WriteAnswerNotFound(json::Writer& jw, const int id);
+void WriteAnswerBusStatistics(json::Writer& jw, const RequestHandler& rh, const int id, const std::string& name);
+void WriteAnswerBusesByStop(json::Writer& jw, const RequestHandler& rh, const int id, const std::string& name);
+void WriteAnswerRoute(json::Writer& jw, const TransportRouter& rt, const int id, const std::string& from, const std::string& to);
+void WriteAnswerRouteByPoints(json::Writer& jw, const RequestHandler& rh, const int id);
+void WriteAnswerRouteInfo(json::Writer& jw, const std::optional<RouterInfo>& optim_route, const int id);
+void WriteAnswerRoutes(json::Writer& jw, const RequestHandler& rh, const int id, const std::string& from, const std::string& to);
+// Ключ items маршрута; записывается первым, до остальных ключей словаря
+void AddRouteItems(json::Writer& jw, const RouterInfo& route);
+void WriteAnswerSvgMap(json::Writer& jw, const RequestHandler& rh, const int id);
+void WriteAnswerNearestStops(json::Writer& jw, const RequestHandler& rh, const int id);
+void WriteAnswerStopsInBox(json::Writer& jw, const RequestHandler& rh, const int id);
+void WriteAnswerTop(json::Writer& jw, const RequestHandler& rh, const int id);
+void WriteAnswerMemoryStats(json::Writer& jw, const RequestHandler& rh, const int id);
+void WriteAnswerSearchNames(json::Writer& jw, const RequestHandler& rh, const int id, bool fuzzy);
 void LoadRendererSettingFromJson(MapRenderer& mr, const json::Document& doc);
-void LoadStops(TransportCatalogue& tc, const Array& stop_desc);
-void LoadStopsDistance(TransportCatalogue& tc, const Array& stop_desc);
-void LoadBuses(TransportCatalogue& tc, const Array& stop_desc);
+vector<string_view> GetBusStopsFromJson(const Dict& bus_dict);
+// Удаление и изменение маршрутов и остановок из секции update_requests
+void ApplyUpdatesFromJson(TransportCatalogue& tc, const json::Document& doc);
 void LoadTransportRouterFromJson(TransportRouter& rt, const json::Document& doc);
 void LoadTransportDataFromJson(TransportCatalogue& tc, TransportRouter& rt, const json::Document& doc);
+// Многорегиональный вход: общие render_settings и routing_settings, секция regions
+// с id, name_prefix, base_requests и необязательными routing_settings региона
+void LoadPartitionedCatalogueFromJson(PartitionedCatalogue& pc, const json::Document& doc);
+std::optional<PartitionedCatalogue::RegionId> FindRequestRegion(const PartitionedCatalogue& pc, const Dict& request);
+void PrintPartitionedAnswerToJson(const PartitionedCatalogue& pc, const json::Document& doc, std::ostream& output, const json::PrintOptions& options = {});
+void PrintImageAnswerToJson(const CatalogueImage& image, const json::Document& doc, std::ostream& output, const json::PrintOptions& options = {});
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "json.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define JSON_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// Общие для разбора документа, потокового чтения и записи операции над буфером символов
+namespace json::scan {
+
+    inline bool IsSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+    }
+
+    inline bool IsDigit(int c) {
+        return c >= '0' && c <= '9';
+    }
+
+    // Первый непробельный символ в [pos, end) или end; длинные отступы - блоками по 16 байт
+    inline const char* SkipSpaces(const char* pos, const char* end) {
+        while (pos != end) {
+#ifdef JSON_USE_SSE2
+            if (end - pos >= 16) {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+                const __m128i spaces = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))));
+                const unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(spaces)) & 0xFFFFu;
+                if (mask == 0) {
+                    pos += 16;
+                    continue;
+                }
+                pos += std::countr_zero(mask);
+            }
+#endif
+            if (!IsSpace(*pos)) {
+                return pos;
+            }
+            ++pos;
+        }
+        return end;
+    }
+
+    // Позиция первого из символов ", \, \n, \r в [pos, end) или end. Внутри строки все остальные
+    // символы копируются как есть, поэтому их можно пропускать блоками по 16 байт
+    inline const char* FindStringSpecial(const char* pos, const char* end) {
+#ifdef JSON_USE_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i line_feed = _mm_set1_epi8('\n');
+        const __m128i carriage_return = _mm_set1_epi8('\r');
+        for (; end - pos >= 16; pos += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+            const __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, line_feed), _mm_cmpeq_epi8(chunk, carriage_return)));
+            if (const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits)); mask != 0) {
+                return pos + std::countr_zero(mask);
+            }
+        }
+#endif
+        for (; pos != end; ++pos) {
+            if (*pos == '"' || *pos == '\\' || *pos == '\n' || *pos == '\r') {
+                return pos;
+            }
+        }
+        return end;
+    }
+
+    // Позиция первого символа, который при выводе строки заменяется escape-последовательностью
+    // (", \, \n, \r, \t), в [pos, end) или end. Участки между ними выводятся целиком
+    inline const char* FindEscapeSpecial(const char* pos, const char* end) {
+#ifdef JSON_USE_SSE2
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i line_feed = _mm_set1_epi8('\n');
+        const __m128i carriage_return = _mm_set1_epi8('\r');
+        const __m128i tab = _mm_set1_epi8('\t');
+        for (; end - pos >= 16; pos += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+            const __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, line_feed), _mm_cmpeq_epi8(chunk, carriage_return)),
+                    _mm_cmpeq_epi8(chunk, tab)));
+            if (const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits)); mask != 0) {
+                return pos + std::countr_zero(mask);
+            }
+        }
+#endif
+        for (; pos != end; ++pos) {
+            if (*pos == '"' || *pos == '\\' || *pos == '\n' || *pos == '\r' || *pos == '\t') {
+                return pos;
+            }
+        }
+        return end;
+    }
+
+    // Сборка словарей при разборе. Пары накапливаются в буфере своего уровня вложенности в порядке
+    // чтения, порядок ключей держится отдельным массивом номеров, поэтому пары не сдвигаются при вставке.
+    // Буферы переиспользуются, готовый словарь выделяет память из resource один раз.
+    // После исключения разбора объект не используется
+    class DictScratch {
+    public:
+        class Level {
+        public:
+            // Позиция key среди упорядоченных ключей; ParsingError, если ключ уже есть
+            size_t FindPosition(const std::string& key) const {
+                using namespace std::literals;
+                const auto itr = std::lower_bound(order_.begin(), order_.end(), key,
+                    [this](uint32_t index, const std::string& key) { return items_[index].first < key; });
+                if (itr != order_.end() && items_[*itr].first == key) {
+                    throw ParsingError("Duplicate key '"s + key + "' have been found");
+                }
+                return static_cast<size_t>(itr - order_.begin());
+            }
+
+            void Insert(size_t position, std::string key, Node value) {
+                items_.emplace_back(std::move(key), std::move(value));
+                order_.insert(order_.begin() + position, static_cast<uint32_t>(items_.size() - 1));
+            }
+
+        private:
+            friend class DictScratch;
+            std::vector<Dict::value_type> items_;
+            std::vector<uint32_t> order_;
+        };
+
+        Level& Open() {
+            if (depth_ == levels_.size()) {
+                levels_.emplace_back();
+            }
+            Level& level = levels_[depth_++];
+            level.items_.clear();
+            level.order_.clear();
+            return level;
+        }
+
+        Dict Close(std::pmr::memory_resource* resource) {
+            Level& level = levels_[--depth_];
+            Dict dict(resource);
+            dict.reserve(level.items_.size());
+            for (const uint32_t index : level.order_) {
+                dict.emplace(std::move(level.items_[index].first), std::move(level.items_[index].second));
+            }
+            return dict;
+        }
+
+    private:
+        // deque не перемещает буферы внешних уровней, пока разбираются вложенные
+        std::deque<Level> levels_;
+        size_t depth_ = 0;
+    };
+
+    // Поток целиком; читается крупными блоками, дальше разбор идёт по буферу
+    inline std::shared_ptr<const std::string> ReadAll(std::istream& input) {
+        auto buffer = std::make_shared<std::string>();
+        char chunk[1 << 16];
+        while (input.read(chunk, sizeof(chunk)) || input.gcount() > 0) {
+            buffer->append(chunk, static_cast<size_t>(input.gcount()));
+        }
+        return buffer;
+    }
+
+    // Символ, который обозначает escape-последовательность \escaped_char
+    inline char Unescape(char escaped_char) {
+        using namespace std::literals;
+        switch (escaped_char) {
+        case 'n':
+            return '\n';
+        case 't':
+            return '\t';
+        case 'r':
+            return '\r';
+        case '"':
+            return '"';
+        case '\\':
+            return '\\';
+        default:
+            throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+        }
+    }
+
+    // Число из уже проверенной по грамматике записи: int, если помещается, иначе double.
+    // from_chars не зависит от локали и не требует завершающего нуля
+    inline Node ToNumber(std::string_view parsed_num, bool is_int) {
+        using namespace std::literals;
+        const char* first = parsed_num.data();
+        const char* last = first + parsed_num.size();
+        if (is_int) {
+            int value = 0;
+            if (const auto [ptr, ec] = std::from_chars(first, last, value); ec == std::errc{} && ptr == last) {
+                return value;
+            }
+            // При переполнении int число читается как double
+        }
+        double value = 0.0;
+        if (const auto [ptr, ec] = std::from_chars(first, last, value); ec == std::errc{} && ptr == last) {
+            return value;
+        }
+        throw ParsingError("Failed to convert "s + std::string(parsed_num) + " to number"s);
+    }
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "json.h"
+#include "json_stream.h"
+
+// Разбор объектов известной схемы прямо в структуры: поля различаются по таблице имён,
+// значения читаются из StreamReader без промежуточного словаря на каждый объект
+namespace json::schema {
+
+    // Таблица имён полей с совершенным хешем: номер поля - одно вычисление хеша и одно сравнение строк.
+    // Начальное значение хеша, при котором имена не конфликтуют, подбирается при компиляции
+    template <size_t N>
+    class FieldTable {
+    public:
+        static constexpr size_t NOT_FOUND = N;
+
+        consteval explicit FieldTable(const std::array<std::string_view, N>& names)
+            : names_(names) {
+            for (uint32_t seed = 0; seed < MAX_SEED; ++seed) {
+                if (TryPlace(seed)) {
+                    seed_ = seed;
+                    return;
+                }
+            }
+            // Недостижимо для небольших таблиц; при вычислении на этапе компиляции - ошибка сборки
+            throw "No perfect hash for the field names";
+        }
+
+        // Номер имени key в таблице или NOT_FOUND
+        constexpr size_t Find(std::string_view key) const {
+            const size_t index = slots_[Hash(key, seed_) & (SLOT_COUNT - 1)];
+            return index != NOT_FOUND && names_[index] == key ? index : NOT_FOUND;
+        }
+
+        constexpr std::string_view GetName(size_t index) const {
+            return names_[index];
+        }
+
+    private:
+        static constexpr size_t SLOT_COUNT = std::bit_ceil(N * 2);
+        static constexpr uint32_t MAX_SEED = 1 << 16;
+
+        // FNV-1a с подмешанным seed
+        static constexpr uint32_t Hash(std::string_view key, uint32_t seed) {
+            uint32_t hash = 2166136261u ^ seed;
+            for (const char c : key) {
+                hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+            }
+            return hash ^ (hash >> 16);
+        }
+
+        constexpr bool TryPlace(uint32_t seed) {
+            slots_.fill(NOT_FOUND);
+            for (size_t i = 0; i < N; ++i) {
+                size_t& slot = slots_[Hash(names_[i], seed) & (SLOT_COUNT - 1)];
+                if (slot != NOT_FOUND) {
+                    return false;
+                }
+                slot = i;
+            }
+            return true;
+        }
+
+        std::array<std::string_view, N> names_;
+        std::array<size_t, SLOT_COUNT> slots_{};
+        uint32_t seed_ = 0;
+    };
+
+    // Ошибки типов значений полей. Значение неверного типа дочитывается целиком, поэтому разбор объекта
+    // продолжается, а вызывающий решает, нужна ли ему ошибка: например, объект неизвестного типа пропускается.
+    // Хранится первая ошибка; ошибки синтаксиса и повторы ключей не откладываются
+    class FieldErrors {
+    public:
+        void Add(std::string message) {
+            if (first_.empty()) {
+                first_ = std::move(message);
+            }
+        }
+
+        // ParsingError с первой ошибкой, если она была
+        void Throw() const {
+            if (!first_.empty()) {
+                throw ParsingError(first_);
+            }
+        }
+
+    private:
+        std::string first_;
+    };
+
+    // Значение поля field из потока: bool, int, double (принимает и целые, как Node::AsDouble) или строка.
+    // Другой тип значения - ошибка в errors
+    template <typename Value>
+    void ReadValue(StreamReader& reader, std::string_view field, Value& value, FieldErrors& errors) {
+        using namespace std::literals;
+        if (const StreamReader::Token token = reader.Next(); token == StreamReader::Token::VALUE) {
+            Node node = reader.TakeValue();
+            if constexpr (std::is_same_v<Value, std::string>) {
+                if (std::string* text = std::get_if<std::string>(&node.GetValue())) {
+                    value = std::move(*text);
+                    return;
+                }
+            }
+            else if constexpr (std::is_same_v<Value, double>) {
+                if (node.IsDouble()) {
+                    value = node.AsDouble();
+                    return;
+                }
+            }
+            else if constexpr (std::is_same_v<Value, int>) {
+                if (node.IsInt()) {
+                    value = node.AsInt();
+                    return;
+                }
+            }
+            else {
+                static_assert(std::is_same_v<Value, bool>, "Unsupported field type");
+                if (node.IsBool()) {
+                    value = node.AsBool();
+                    return;
+                }
+            }
+        }
+        else {
+            reader.ReadNode(token);
+        }
+        errors.Add("Field '"s + std::string(field) + "' has unexpected type"s);
+    }
+
+    // Массив - значение поля field: on_item(token) читает очередной элемент сам.
+    // Другое значение - ошибка в errors
+    template <typename OnItem>
+    void ReadArray(StreamReader& reader, std::string_view field, FieldErrors& errors, OnItem&& on_item) {
+        using namespace std::literals;
+        using Token = StreamReader::Token;
+        if (const Token token = reader.Next(); token != Token::START_ARRAY) {
+            reader.ReadNode(token);
+            errors.Add("Field '"s + std::string(field) + "' is not an array"s);
+            return;
+        }
+        // Следующий токен элемента уже прочитан; on_item получает его, чтобы дочитать элемент
+        for (Token token = reader.Next(); token != Token::END_ARRAY; token = reader.Next()) {
+            on_item(token);
+        }
+    }
+
+    // Словарь - значение поля field: on_item(key) читает значение ключа сам.
+    // Другое значение - ошибка в errors
+    template <typename OnItem>
+    void ReadDict(StreamReader& reader, std::string_view field, FieldErrors& errors, OnItem&& on_item) {
+        using namespace std::literals;
+        using Token = StreamReader::Token;
+        if (const Token token = reader.Next(); token != Token::START_DICT) {
+            reader.ReadNode(token);
+            errors.Add("Field '"s + std::string(field) + "' is not a dict"s);
+            return;
+        }
+        for (Token token = reader.Next(); token != Token::END_DICT; token = reader.Next()) {
+            on_item(reader.GetKey());
+        }
+    }
+
+    // Объект, который начался токеном START_DICT: для каждого ключа вызывается on_field(номер поля, ключ),
+    // номер - из fields или NOT_FOUND; on_field читает значение сам. Возвращает маску прочитанных полей.
+    // Повтор известного поля - ParsingError, как у json::Load
+    template <size_t N, typename OnField>
+    uint64_t ReadObject(StreamReader& reader, const FieldTable<N>& fields, OnField&& on_field) {
+        static_assert(N <= 64, "Field mask is 64 bits wide");
+        using namespace std::literals;
+        using Token = StreamReader::Token;
+        uint64_t seen = 0;
+        for (Token token = reader.Next(); token != Token::END_DICT; token = reader.Next()) {
+            const std::string& key = reader.GetKey();
+            const size_t index = fields.Find(key);
+            if (index != FieldTable<N>::NOT_FOUND) {
+                const uint64_t bit = uint64_t{ 1 } << index;
+                if (seen & bit) {
+                    throw ParsingError("Duplicate key '"s + key + "' have been found");
+                }
+                seen |= bit;
+            }
+            on_field(index, key);
+        }
+        return seen;
+    }
+
+    // Первое из обязательных полей required (маска номеров), которого нет в seen, - ParsingError
+    template <size_t N>
+    void CheckRequired(const FieldTable<N>& fields, uint64_t seen, uint64_t required) {
+        using namespace std::literals;
+        if (const uint64_t missing = required & ~seen; missing != 0) {
+            throw ParsingError("Field '"s + std::string(fields.GetName(std::countr_zero(missing))) + "' is missing"s);
+        }
+    }
+}
@@ -0,0 +1,257 @@
+#include "json_stream.h"
+
+#include <cctype>
+
+namespace json {
+
+    using namespace std::literals;
+
+    StreamReader::StreamReader(std::istream& input, size_t buffer_size, std::pmr::memory_resource* resource)
+        : input_(input)
+        , buffer_(buffer_size > 0 ? buffer_size : 1)
+        , resource_(resource) {
+    }
+
+    bool StreamReader::Fill() {
+        input_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        pos_ = buffer_.data();
+        end_ = pos_ + input_.gcount();
+        return pos_ != end_;
+    }
+
+    int StreamReader::Peek() {
+        if (pos_ == end_ && !Fill()) {
+            return std::char_traits<char>::eof();
+        }
+        return static_cast<unsigned char>(*pos_);
+    }
+
+    bool StreamReader::ReadChar(char& c) {
+        while (true) {
+            pos_ = scan::SkipSpaces(pos_, end_);
+            if (pos_ != end_) {
+                c = *pos_++;
+                return true;
+            }
+            if (!Fill()) {
+                return false;
+            }
+        }
+    }
+
+    StreamReader::Token StreamReader::Next() {
+        char c;
+        while (true) {
+            if (levels_.empty()) {
+                if (root_done_) {
+                    return Token::END;
+                }
+                if (!ReadChar(c)) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                return ReadValue(c);
+            }
+
+            Level& level = levels_.back();
+            if (!ReadChar(c)) {
+                if (level.is_dict && !level.expect_key) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                throw ParsingError(level.is_dict ? "Dictionary parsing error"s : "Array parsing error"s);
+            }
+            if (!level.is_dict) {
+                if (c == ']') {
+                    levels_.pop_back();
+                    return Token::END_ARRAY;
+                }
+                // После запятой обязательно идёт элемент
+                if (c == ',' && !ReadChar(c)) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                return ReadValue(c);
+            }
+            else if (!level.expect_key) {
+                level.expect_key = true;
+                return ReadValue(c);
+            }
+            else if (c == '}') {
+                levels_.pop_back();
+                return Token::END_DICT;
+            }
+            else if (c == '"') {
+                key_ = ReadString();
+                if (!ReadChar(c) || c != ':') {
+                    throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                }
+                level.expect_key = false;
+                return Token::KEY;
+            }
+            else if (c != ',') {
+                throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+            }
+        }
+    }
+
+    StreamReader::Token StreamReader::ReadValue(char c) {
+        if (levels_.empty()) {
+            root_done_ = true;
+        }
+        switch (c) {
+        case '[':
+            levels_.push_back({ false, false });
+            return Token::START_ARRAY;
+        case '{':
+            levels_.push_back({ true, true });
+            return Token::START_DICT;
+        case '"':
+            value_ = Node(ReadString());
+            return Token::VALUE;
+        case 't':
+            [[fallthrough]];
+        case 'f': {
+            --pos_;
+            const std::string s = ReadLiteral();
+            if (s != "true"sv && s != "false"sv) {
+                throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+            }
+            value_ = Node(s == "true"sv);
+            return Token::VALUE;
+        }
+        case 'n': {
+            --pos_;
+            if (const std::string literal = ReadLiteral(); literal != "null"sv) {
+                throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+            }
+            value_ = Node(nullptr);
+            return Token::VALUE;
+        }
+        default:
+            --pos_;
+            value_ = ReadNumber();
+            return Token::VALUE;
+        }
+    }
+
+    const std::string& StreamReader::GetKey() const {
+        return key_;
+    }
+
+    Node StreamReader::TakeValue() {
+        return std::move(value_);
+    }
+
+    Node StreamReader::ReadNode(Token token) {
+        switch (token) {
+        case Token::VALUE:
+            return TakeValue();
+        case Token::START_ARRAY: {
+            Array result(resource_);
+            for (Token item = Next(); item != Token::END_ARRAY; item = Next()) {
+                result.push_back(ReadNode(item));
+            }
+            return Node(std::move(result));
+        }
+        case Token::START_DICT: {
+            scan::DictScratch::Level& level = dict_scratch_.Open();
+            for (Token item = Next(); item != Token::END_DICT; item = Next()) {
+                std::string key = std::move(key_);
+                const size_t position = level.FindPosition(key);
+                Node value = ReadNode(Next());
+                level.Insert(position, std::move(key), std::move(value));
+            }
+            return Node(dict_scratch_.Close(resource_));
+        }
+        default:
+            throw ParsingError("Unexpected end of node"s);
+        }
+    }
+
+    // Открывающая кавычка уже прочитана; строка может пересекать границу блоков
+    std::string StreamReader::ReadString() {
+        std::string s;
+        while (true) {
+            const char* special = scan::FindStringSpecial(pos_, end_);
+            s.append(pos_, special);
+            pos_ = special;
+            if (pos_ == end_) {
+                if (!Fill()) {
+                    throw ParsingError("String parsing error");
+                }
+                continue;
+            }
+            const char ch = *pos_++;
+            if (ch == '"') {
+                break;
+            }
+            if (ch != '\\') {
+                throw ParsingError("Unexpected end of line"s);
+            }
+            if (Peek() == std::char_traits<char>::eof()) {
+                throw ParsingError("String parsing error");
+            }
+            s.push_back(scan::Unescape(*pos_++));
+        }
+        return s;
+    }
+
+    std::string StreamReader::ReadLiteral() {
+        std::string s;
+        for (int c = Peek(); c != std::char_traits<char>::eof() && std::isalpha(c); c = Peek()) {
+            s.push_back(*pos_++);
+        }
+        return s;
+    }
+
+    Node StreamReader::ReadNumber() {
+        // Запись числа может пересекать границу блоков, поэтому собирается в буфер, который переиспользуется
+        std::string& parsed_num = number_;
+        parsed_num.clear();
+
+        // Считывает в parsed_num очередной символ
+        auto read_char = [this, &parsed_num] {
+            parsed_num.push_back(*pos_++);
+        };
+
+        // Считывает одну или более цифр в parsed_num
+        auto read_digits = [this, read_char] {
+            if (!scan::IsDigit(Peek())) {
+                throw ParsingError("A digit is expected"s);
+            }
+            while (scan::IsDigit(Peek())) {
+                read_char();
+            }
+        };
+
+        if (Peek() == '-') {
+            read_char();
+        }
+        // Парсим целую часть числа
+        if (Peek() == '0') {
+            read_char();
+            // После 0 в JSON не могут идти другие цифры
+        }
+        else {
+            read_digits();
+        }
+
+        bool is_int = true;
+        // Парсим дробную часть числа
+        if (Peek() == '.') {
+            read_char();
+            read_digits();
+            is_int = false;
+        }
+
+        // Парсим экспоненциальную часть числа
+        if (int ch = Peek(); ch == 'e' || ch == 'E') {
+            read_char();
+            if (ch = Peek(); ch == '+' || ch == '-') {
+                read_char();
+            }
+            read_digits();
+            is_int = false;
+        }
+
+        return scan::ToNumber(parsed_num, is_int);
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <istream>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "json.h"
+#include "json_scan.h"
+
+namespace json {
+
+    // Потоковое чтение JSON событиями без построения дерева документа.
+    // Вход читается блоками фиксированного размера, поэтому занятая память определяется глубиной
+    // вложенности и длиной отдельных строк, а не размером входа. Грамматика и сообщения об ошибках
+    // совпадают с json::Load; после корневого узла остаток потока не читается.
+    class StreamReader {
+    public:
+        enum class Token {
+            START_ARRAY,
+            END_ARRAY,
+            START_DICT,
+            END_DICT,
+            KEY,    // имя ключа - GetKey(), следующее событие начинает его значение
+            VALUE,  // строка, число, bool или null - TakeValue()
+            END     // корневой узел прочитан
+        };
+
+        // Массивы и словари, которые строит ReadNode, размещаются в resource
+        explicit StreamReader(std::istream& input, size_t buffer_size = 1 << 16,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        Token Next();
+        const std::string& GetKey() const;
+        Node TakeValue();
+
+        // Дочитывает узел, который начинается событием token, и строит его дерево.
+        // Так обработчик собирает небольшие поддеревья, не загружая документ целиком
+        Node ReadNode(Token token);
+
+    private:
+        struct Level {
+            bool is_dict = false;
+            bool expect_key = true;
+        };
+
+        bool Fill();
+        int Peek();
+        bool ReadChar(char& c);
+        Token ReadValue(char c);
+        std::string ReadString();
+        std::string ReadLiteral();
+        Node ReadNumber();
+
+    private:
+        std::istream& input_;
+        std::vector<char> buffer_;
+        const char* pos_ = nullptr;
+        const char* end_ = nullptr;
+        std::vector<Level> levels_;
+        bool root_done_ = false;
+        std::string key_;
+        std::string number_;
+        Node value_;
+        std::pmr::memory_resource* resource_;
+        scan::DictScratch dict_scratch_;
+    };
+}
@@ -0,0 +1,433 @@
+#include "json_writer.h"
+
+#include "json_msgpack.h"
+#include "json_scan.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <stdexcept>
+#include <type_traits>
+
+namespace json {
+
+    using namespace std::literals;
+
+    namespace {
+        constexpr size_t INDENT_STEP = 4;
+        // Место под заголовок массива или словаря, размер которого станет известен при закрытии
+        constexpr size_t MAX_HEADER_SIZE = 5;
+
+        // Старшие байты вперёд, как в MessagePack
+        void StoreBigEndian(char* out, uint64_t value, size_t bytes) {
+            for (size_t i = bytes; i > 0; --i) {
+                out[i - 1] = static_cast<char>(value & 0xff);
+                value >>= 8;
+            }
+        }
+
+        // Заголовок MessagePack массива или словаря из size элементов; возвращает его длину
+        size_t EncodeContainerHeader(char* out, bool is_dict, size_t size) {
+            if (size <= msgpack::FIX_CONTAINER_MAX) {
+                out[0] = static_cast<char>((is_dict ? msgpack::FIXMAP : msgpack::FIXARRAY) | size);
+                return 1;
+            }
+            if (size <= 0xffff) {
+                out[0] = static_cast<char>(is_dict ? msgpack::MAP16 : msgpack::ARRAY16);
+                StoreBigEndian(out + 1, size, 2);
+                return 3;
+            }
+            out[0] = static_cast<char>(is_dict ? msgpack::MAP32 : msgpack::ARRAY32);
+            StoreBigEndian(out + 1, size, 4);
+            return MAX_HEADER_SIZE;
+        }
+    }
+
+    Writer::Writer(std::ostream& output, const PrintOptions& options, size_t buffer_size)
+        : out_(output)
+        , options_(options)
+        , binary_(options.format == Format::MSGPACK)
+        , buffer_size_(buffer_size > 0 ? buffer_size : 1) {
+        buffer_.reserve(buffer_size_);
+    }
+
+    Writer::~Writer() {
+        Flush();
+    }
+
+    void Writer::Finish() {
+        if (!started_ || depth_ != 0) {
+            throw std::logic_error("Attempt to build JSON which isn't finalized"s);
+        }
+        Flush();
+    }
+
+    Writer::Level* Writer::GetTopLevel() {
+        if (depth_ == 0) {
+            if (started_) {
+                throw std::logic_error("Error - JSON is not finish"s);
+            }
+            return nullptr;
+        }
+        return &levels_[depth_ - 1];
+    }
+
+    void Writer::BeginValue() {
+        if (depth_ == 0) {
+            started_ = true;
+            return;
+        }
+        Level& level = levels_[depth_ - 1];
+        if (level.is_dict) {
+            // Ключ с отступом уже выведен
+            level.key_written = false;
+            return;
+        }
+        BeginItem(level);
+    }
+
+    void Writer::BeginItem(Level& level) {
+        if (binary_) {
+            ++level.count;
+            return;
+        }
+        if (level.count++ > 0) {
+            Put(',');
+            if (!options_.compact) {
+                Put('\n');
+            }
+        }
+        WriteIndent(depth_);
+    }
+
+    void Writer::PushLevel(bool is_dict, size_t size) {
+        if (depth_ == levels_.size()) {
+            levels_.emplace_back();
+        }
+        Level& level = levels_[depth_++];
+        level.is_dict = is_dict;
+        level.key_written = false;
+        level.count = 0;
+        level.size = size;
+        if (binary_) {
+            char header[MAX_HEADER_SIZE];
+            if (size != UNKNOWN_SIZE) {
+                Put(std::string_view(header, EncodeContainerHeader(header, is_dict, size)));
+            }
+            else {
+                // Заголовок дописывается при закрытии, до тех пор буфер не выводится
+                level.header_pos = buffer_.size();
+                buffer_.append(MAX_HEADER_SIZE, '\0');
+                ++pending_headers_;
+            }
+            return;
+        }
+        Put(is_dict ? '{' : '[');
+        if (!options_.compact) {
+            Put('\n');
+        }
+    }
+
+    void Writer::PopLevel(char close) {
+        const Level& level = levels_[depth_ - 1];
+        if (level.size != UNKNOWN_SIZE && level.count != level.size) {
+            throw std::logic_error("Number of items differs from the declared size"s);
+        }
+        --depth_;
+        if (binary_) {
+            if (level.size == UNKNOWN_SIZE) {
+                char header[MAX_HEADER_SIZE];
+                const size_t length = EncodeContainerHeader(header, level.is_dict, level.count);
+                buffer_.replace(level.header_pos, MAX_HEADER_SIZE, header, length);
+                --pending_headers_;
+            }
+            return;
+        }
+        if (!options_.compact) {
+            Put('\n');
+            WriteIndent(depth_);
+        }
+        Put(close);
+    }
+
+    Writer::DictValueContext Writer::Key(std::string_view key) {
+
+        Level* level = GetTopLevel();
+
+        if (level == nullptr || !level->is_dict || level->key_written) {
+            throw std::logic_error("Dict was not expected here"s);
+        }
+        if (level->count > 0 && key <= level->last_key) {
+            throw std::logic_error("Dict keys must be written in ascending order"s);
+        }
+        level->last_key.assign(key);
+        level->key_written = true;
+
+        BeginItem(*level);
+        WriteString(key);
+        if (!binary_) {
+            Put(options_.compact ? ":"sv : ": "sv);
+        }
+        return DictValueContext{ *this };
+    }
+
+    Writer::BaseContext Writer::Value(Scalar value) {
+
+        const Level* level = GetTopLevel();
+
+        if (level != nullptr && level->is_dict && !level->key_written) {
+            throw std::logic_error("Input Value was not expected here"s);
+        }
+        BeginValue();
+        WriteScalar(value);
+        return *this;
+    }
+
+    void Writer::StartContainer(bool is_dict, size_t size) {
+
+        const Level* level = GetTopLevel();
+
+        if (level != nullptr && level->is_dict && !level->key_written) {
+            throw std::logic_error("Can not create new object"s);
+        }
+        BeginValue();
+        PushLevel(is_dict, size);
+    }
+
+    Writer::DictItemContext Writer::StartDict() {
+        StartContainer(true, UNKNOWN_SIZE);
+        return DictItemContext{ *this };
+    }
+
+    Writer::ArrayItemContext Writer::StartArray() {
+        StartContainer(false, UNKNOWN_SIZE);
+        return BaseContext{ *this };
+    }
+
+    Writer::ArrayItemContext Writer::StartArray(size_t size) {
+        StartContainer(false, size);
+        return BaseContext{ *this };
+    }
+
+    Writer::BaseContext Writer::EndDict() {
+
+        const Level* level = GetTopLevel();
+
+        if (level == nullptr || !level->is_dict || level->key_written) {
+            throw std::logic_error("EndDict was not expected here"s);
+        }
+        PopLevel('}');
+        return *this;
+    }
+
+    Writer::BaseContext Writer::EndArray() {
+
+        const Level* level = GetTopLevel();
+
+        if (level == nullptr || level->is_dict) {
+            throw std::logic_error("EndArray was not expected here"s);
+        }
+        PopLevel(']');
+        return *this;
+    }
+
+    Writer::BaseContext Writer::WriteNode(const Node& node) {
+        return std::visit(
+            [this](const auto& value) -> BaseContext {
+                using Type = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<Type, Array>) {
+                    StartContainer(false, value.size());
+                    for (const Node& item : value) {
+                        WriteNode(item);
+                    }
+                    return EndArray();
+                }
+                else if constexpr (std::is_same_v<Type, Dict>) {
+                    StartContainer(true, value.size());
+                    for (const auto& [key, item] : value) {
+                        Key(key);
+                        WriteNode(item);
+                    }
+                    return EndDict();
+                }
+                else if constexpr (std::is_same_v<Type, StringRef>) {
+                    return Value(value.value);
+                }
+                else if constexpr (std::is_same_v<Type, std::string>) {
+                    return Value(std::string_view(value));
+                }
+                else {
+                    return Value(value);
+                }
+            },
+            node.GetValue());
+    }
+
+    void Writer::Put(char c) {
+        if (buffer_.size() >= buffer_size_ && pending_headers_ == 0) {
+            Flush();
+        }
+        buffer_.push_back(c);
+    }
+
+    void Writer::Put(std::string_view text) {
+        if (buffer_.size() + text.size() > buffer_size_ && pending_headers_ == 0) {
+            Flush();
+            if (text.size() >= buffer_size_) {
+                out_.write(text.data(), static_cast<std::streamsize>(text.size()));
+                return;
+            }
+        }
+        buffer_.append(text);
+    }
+
+    void Writer::Flush() {
+        if (!buffer_.empty()) {
+            out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            buffer_.clear();
+        }
+    }
+
+    void Writer::WriteIndent(size_t depth) {
+        if (options_.compact || binary_) {
+            return;
+        }
+        static constexpr std::string_view spaces = "                                "sv;
+        for (size_t count = depth * INDENT_STEP; count > 0;) {
+            const size_t chunk = std::min(count, spaces.size());
+            Put(spaces.substr(0, chunk));
+            count -= chunk;
+        }
+    }
+
+    // Участки без спецсимволов выводятся целиком, спецсимволы - escape-последовательностями
+    void Writer::WriteString(std::string_view value) {
+        if (binary_) {
+            if (value.size() <= msgpack::FIXSTR_MAX) {
+                Put(static_cast<char>(msgpack::FIXSTR | value.size()));
+            }
+            else if (value.size() <= 0xff) {
+                PutBigEndian(msgpack::STR8, value.size(), 1);
+            }
+            else if (value.size() <= 0xffff) {
+                PutBigEndian(msgpack::STR16, value.size(), 2);
+            }
+            else {
+                PutBigEndian(msgpack::STR32, value.size(), 4);
+            }
+            Put(value);
+            return;
+        }
+        Put('"');
+        const char* pos = value.data();
+        const char* end = pos + value.size();
+        while (true) {
+            const char* special = scan::FindEscapeSpecial(pos, end);
+            Put(std::string_view(pos, static_cast<size_t>(special - pos)));
+            if (special == end) {
+                break;
+            }
+            switch (*special) {
+            case '\r':
+                Put("\\r"sv);
+                break;
+            case '\n':
+                Put("\\n"sv);
+                break;
+            case '\t':
+                Put("\\t"sv);
+                break;
+            case '"':
+                Put("\\\""sv);
+                break;
+            default:
+                Put("\\\\"sv);
+                break;
+            }
+            pos = special + 1;
+        }
+        Put('"');
+    }
+
+    void Writer::PutBigEndian(uint8_t type, uint64_t value, size_t bytes) {
+        char typed[9];
+        typed[0] = static_cast<char>(type);
+        StoreBigEndian(typed + 1, value, bytes);
+        Put(std::string_view(typed, bytes + 1));
+    }
+
+    // Целые - в самой короткой записи, double - всегда float64, чтобы значение читалось без потерь
+    void Writer::WriteBinaryScalar(const Scalar& value) {
+        if (const int* number = std::get_if<int>(&value)) {
+            const int64_t integer = *number;
+            if (integer >= 0) {
+                if (integer <= msgpack::POSITIVE_FIXINT_MAX) {
+                    Put(static_cast<char>(integer));
+                }
+                else if (integer <= 0xff) {
+                    PutBigEndian(msgpack::UINT8, static_cast<uint64_t>(integer), 1);
+                }
+                else if (integer <= 0xffff) {
+                    PutBigEndian(msgpack::UINT16, static_cast<uint64_t>(integer), 2);
+                }
+                else {
+                    PutBigEndian(msgpack::UINT32, static_cast<uint64_t>(integer), 4);
+                }
+            }
+            else if (integer >= -32) {
+                Put(static_cast<char>(integer));
+            }
+            else if (integer >= INT8_MIN) {
+                PutBigEndian(msgpack::INT8, static_cast<uint8_t>(integer), 1);
+            }
+            else if (integer >= INT16_MIN) {
+                PutBigEndian(msgpack::INT16, static_cast<uint16_t>(integer), 2);
+            }
+            else {
+                PutBigEndian(msgpack::INT32, static_cast<uint32_t>(integer), 4);
+            }
+        }
+        else if (const double* number = std::get_if<double>(&value)) {
+            PutBigEndian(msgpack::FLOAT64, std::bit_cast<uint64_t>(*number), 8);
+        }
+        else if (const std::string_view* text = std::get_if<std::string_view>(&value)) {
+            WriteString(*text);
+        }
+        else if (const bool* flag = std::get_if<bool>(&value)) {
+            Put(static_cast<char>(*flag ? msgpack::BOOL_TRUE : msgpack::BOOL_FALSE));
+        }
+        else {
+            Put(static_cast<char>(msgpack::NIL));
+        }
+    }
+
+    // Числа выводятся через to_chars: без локали и без форматирования потока
+    void Writer::WriteScalar(const Scalar& value) {
+        if (binary_) {
+            WriteBinaryScalar(value);
+            return;
+        }
+        if (const int* number = std::get_if<int>(&value)) {
+            char buffer[16];
+            const auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), *number);
+            Put(std::string_view(buffer, static_cast<size_t>(ptr - buffer)));
+        }
+        else if (const double* number = std::get_if<double>(&value)) {
+            // Хватает и на кратчайшую запись, и на 6 значащих цифр с показателем
+            char buffer[32];
+            const auto [ptr, ec] = options_.round_trip_doubles
+                ? std::to_chars(buffer, buffer + sizeof(buffer), *number)
+                : std::to_chars(buffer, buffer + sizeof(buffer), *number, std::chars_format::general, 6);
+            Put(std::string_view(buffer, static_cast<size_t>(ptr - buffer)));
+        }
+        else if (const std::string_view* text = std::get_if<std::string_view>(&value)) {
+            WriteString(*text);
+        }
+        else if (const bool* flag = std::get_if<bool>(&value)) {
+            Put(*flag ? "true"sv : "false"sv);
+        }
+        else {
+            Put("null"sv);
+        }
+    }
+}
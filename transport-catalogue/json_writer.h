@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "json.h"
+
+namespace json {
+
+    // Потоковая запись JSON с тем же интерфейсом, что у json::Builder, но без построения дерева:
+    // каждый вызов сразу выводит свою часть текста. Формат совпадает с json::Print,
+    // поэтому ключи словаря нужно передавать в порядке возрастания, как их выводит Print;
+    // нарушение порядка, как и вызов не к месту, - std::logic_error.
+    // Текст копится в буфере и уходит в output блоками по buffer_size байт, остаток - в Finish
+    // или в деструкторе; длинные строки без спецсимволов передаются в output без копирования в буфер.
+    // С Format::MSGPACK вместо текста записывается MessagePack (json_msgpack.h)
+    class Writer {
+    private:
+        class BaseContext;
+        class DictValueContext;
+        class DictItemContext;
+        class ArrayItemContext;
+
+    public:
+        // Строки не копируются: string_view достаточно жить до возврата из Value
+        using Scalar = std::variant<std::nullptr_t, bool, int, double, std::string_view>;
+
+        explicit Writer(std::ostream& output, const PrintOptions& options = {}, size_t buffer_size = 1 << 16);
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+        ~Writer();
+
+        // Проверяет, что корневой узел записан целиком, и выводит остаток буфера
+        void Finish();
+
+        DictValueContext Key(std::string_view key);
+        BaseContext Value(Scalar value);
+        DictItemContext StartDict();
+        ArrayItemContext StartArray();
+        // Число элементов известно заранее. Заголовок MessagePack выводится сразу, иначе массив
+        // держит в буфере всё своё содержимое до закрытия; другое число элементов - std::logic_error
+        ArrayItemContext StartArray(size_t size);
+        BaseContext EndDict();
+        BaseContext EndArray();
+
+        // Записывает готовое дерево целиком на место очередного значения
+        BaseContext WriteNode(const Node& node);
+
+    private:
+        static constexpr size_t UNKNOWN_SIZE = SIZE_MAX;
+
+        struct Level {
+            bool is_dict = false;
+            bool key_written = false;
+            size_t count = 0;
+            size_t size = UNKNOWN_SIZE;
+            // Позиция в буфере заголовка MessagePack, который допишется при закрытии
+            size_t header_pos = 0;
+            std::string last_key;
+        };
+
+        // Открытый контейнер или nullptr, если корень ещё не начат
+        Level* GetTopLevel();
+        // Отмечает начало значения: корня, ключа словаря или элемента массива
+        void BeginValue();
+        // Разделитель и отступ перед элементом открытого контейнера
+        void BeginItem(Level& level);
+        void StartContainer(bool is_dict, size_t size);
+        void PushLevel(bool is_dict, size_t size);
+        void PopLevel(char close);
+
+        void Put(char c);
+        void Put(std::string_view text);
+        void PutBigEndian(uint8_t type, uint64_t value, size_t bytes);
+        void Flush();
+        void WriteIndent(size_t depth);
+        void WriteString(std::string_view value);
+        void WriteScalar(const Scalar& value);
+        void WriteBinaryScalar(const Scalar& value);
+
+        std::ostream& out_;
+        PrintOptions options_;
+        bool binary_;
+        std::string buffer_;
+        size_t buffer_size_;
+        // Открытые контейнеры, заголовки которых ещё не дописаны
+        size_t pending_headers_ = 0;
+        // Закрытые уровни не удаляются, чтобы строки last_key использовались повторно
+        std::vector<Level> levels_;
+        size_t depth_ = 0;
+        bool started_ = false;
+
+
+        class BaseContext {
+        public:
+            BaseContext(Writer& writer) : writer_(writer) {}
+            void Finish() {
+                writer_.Finish();
+            }
+            DictValueContext Key(std::string_view key) {
+                return writer_.Key(key);
+            }
+            BaseContext Value(Scalar value) {
+                return writer_.Value(value);
+            }
+            DictItemContext StartDict() {
+                return writer_.StartDict();
+            }
+            ArrayItemContext StartArray() {
+                return writer_.StartArray();
+            }
+            ArrayItemContext StartArray(size_t size) {
+                return writer_.StartArray(size);
+            }
+            BaseContext EndDict() {
+                return writer_.EndDict();
+            }
+            BaseContext EndArray() {
+                return writer_.EndArray();
+            }
+        private:
+            Writer& writer_;
+        };
+
+        class DictValueContext : public BaseContext {
+        public:
+            DictValueContext(BaseContext base) : BaseContext(base) {}
+            DictItemContext Value(Scalar value) { return BaseContext::Value(value); }
+            void Finish() = delete;
+            DictValueContext Key(std::string_view key) = delete;
+            BaseContext EndDict() = delete;
+            BaseContext EndArray() = delete;
+        };
+
+        class DictItemContext : public BaseContext {
+        public:
+            DictItemContext(BaseContext base) : BaseContext(base) {}
+            void Finish() = delete;
+            BaseContext Value(Scalar value) = delete;
+            BaseContext EndArray() = delete;
+            DictItemContext StartDict() = delete;
+            ArrayItemContext StartArray() = delete;
+            ArrayItemContext StartArray(size_t size) = delete;
+        };
+
+        class ArrayItemContext : public BaseContext {
+        public:
+            ArrayItemContext(BaseContext base) : BaseContext(base) {}
+            ArrayItemContext Value(Scalar value) { return BaseContext::Value(value); }
+            void Finish() = delete;
+            DictValueContext Key(std::string_view key) = delete;
+            BaseContext EndDict() = delete;
+        };
+    };
+}
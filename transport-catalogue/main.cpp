@@ -1,27 +1,162 @@
 #include <iostream>
 #include "request_handler.h"
 #include "json_reader.h"
+#include "json_msgpack.h"
 #include "map_renderer.h"
+#include "catalogue_snapshot.h"
+#include "catalogue_image.h"
 
 using namespace std::literals;
 
-int main() {
+namespace {
+    void PrintUpdateStatistic(const TransportCatalogue& tc, std::ostream& output) {
+        for (size_t i = 0; i < static_cast<size_t>(TransportCatalogue::UpdateOperation::COUNT); ++i) {
+            const auto operation = static_cast<TransportCatalogue::UpdateOperation>(i);
+            const TransportCatalogue::UpdateStatistic& statistic = tc.GetUpdateStatistic(operation);
+            if (statistic.count > 0) {
+                output << TransportCatalogue::GetUpdateOperationName(operation) << ": "sv << statistic.count
+                    << " ops, "sv << statistic.total.count() / statistic.count << " ns avg"sv << std::endl;
+            }
+        }
+    }
+
+    json::Document LoadDocument(std::istream& input, json::Format format) {
+        return format == json::Format::MSGPACK ? json::LoadMsgPack(input) : json::Load(input);
+    }
+}
+
+// Параметры командной строки:
+//   --write-image <file>  после загрузки сохранить бинарный образ справочника
+//   --image <file>        отвечать на запросы Bus/Stop из образа, base_requests не нужны
+//   --memory-report       после загрузки вывести в stderr отчёт о занятой памяти и время расчёта статистики автобусов
+//   --compact             выводить ответ без переводов строк и отступов
+//   --format json|msgpack формат запроса и ответа, по умолчанию json; msgpack - MessagePack той же структуры
+// Вход с секцией regions обслуживается многорегиональным справочником PartitionedCatalogue
+int main(int argc, char* argv[]) {
+
+    std::string write_image_path;
+    std::string image_path;
+    bool memory_report = false;
+    json::PrintOptions print_options;
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i] == "--memory-report"sv) {
+            memory_report = true;
+        }
+        else if (argv[i] == "--compact"sv) {
+            print_options.compact = true;
+        }
+        else if (i + 1 == argc) {
+            break;
+        }
+        else if (argv[i] == "--write-image"sv) {
+            write_image_path = argv[++i];
+        }
+        else if (argv[i] == "--image"sv) {
+            image_path = argv[++i];
+        }
+        else if (argv[i] == "--format"sv) {
+            const std::string_view format = argv[++i];
+            if (format == "msgpack"sv) {
+                print_options.format = json::Format::MSGPACK;
+            }
+            else if (format != "json"sv) {
+                std::cerr << "Неизвестный формат: "sv << format << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    if (!image_path.empty()) {
+        try {
+            CatalogueImage image(image_path);
+            PrintImageAnswerToJson(image, LoadDocument(std::cin, print_options.format), std::cout, print_options);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Ошибка чтения образа справочника: "sv << e.what() << std::endl;
+        }
+        return 0;
+    }
+
+    SnapshotStore snapshots;
+    std::unique_ptr<CatalogueSnapshot> snapshot = std::make_unique<CatalogueSnapshot>();
+
+    std::optional<json::Document> doc;
+    try {
+        if (print_options.format == json::Format::MSGPACK) {
+            // Двоичный вход разбирается целиком, строки справочника ссылаются на его буфер
+            doc = LoadDocument(std::cin, print_options.format);
+            if (doc->GetRoot().IsDict() && doc->GetRoot().AsDict().count("base_requests"s) > 0) {
+                LoadTransportCatalogueFromJson(snapshot->catalogue, *doc);
+            }
+        }
+        else {
+            // base_requests попадают в справочник по мере чтения, дерево строится только для остальных секций
+            doc = LoadTransportCatalogueFromStream(snapshot->catalogue, std::cin);
+        }
+    }
+    catch (...) {
+        std::cerr << "Ошибка ввода json-файла"sv << std::endl;
+        std::cin.clear();
+        return 0;
+    }
 
-    TransportCatalogue catalogue;
-    MapRenderer render;
-    TransportRouter router(catalogue);
-    RequestHandler request_handler(catalogue, router, render);
+    if (doc->GetRoot().IsDict() && doc->GetRoot().AsDict().count("regions"s) > 0) {
+        try {
+            PartitionedCatalogue regions;
+            LoadPartitionedCatalogueFromJson(regions, *doc);
+            PrintPartitionedAnswerToJson(regions, *doc, std::cout, print_options);
+        }
+        catch (...) {
+            std::cerr << "Ошибка ввода json-файла"sv << std::endl;
+        }
+        return 0;
+    }
 
     try {
-        json::Document doc = Load(std::cin);
-        LoadTransportDataFromJson(catalogue, router, doc);
-        LoadRendererSettingFromJson(render, doc);
-        AddStatisticsRequestFromJson(request_handler, doc);
+        LoadTransportRouterFromJson(snapshot->router, *doc);
+        snapshot->router.BuildGraphRoute();
+        LoadRendererSettingFromJson(snapshot->renderer, *doc);
+        if (!write_image_path.empty()) {
+            SaveCatalogueImage(snapshot->catalogue, write_image_path);
+        }
+        snapshots.Publish(std::move(snapshot));
+        if (doc->GetRoot().AsDict().count("update_requests"s) > 0) {
+            snapshots.Update([&doc](CatalogueSnapshot& next) {
+                ApplyUpdatesFromJson(next.catalogue, *doc);
+                PrintUpdateStatistic(next.catalogue, std::cerr);
+            });
+        }
     }
     catch (...) {
         std::cerr << "Ошибка ввода json-файла"sv << std::endl;
         std::cin.clear();
         return 0;
     }
-    PrintAnswerToJson(request_handler, std::cout);
-}
\ No newline at end of file
+
+    SnapshotStore::Handle pinned = snapshots.Pin();
+    RequestHandler request_handler(*pinned);
+    request_handler.SetInputDocument(*doc);
+    if (memory_report) {
+        const TransportCatalogue& catalogue = pinned->catalogue;
+        std::cerr << "Bus statistics: "sv << catalogue.GetCountBuses() << " buses, "sv
+            << std::chrono::duration_cast<std::chrono::microseconds>(catalogue.GetStatisticsBuildTime()).count() << " us"sv << std::endl;
+        memory::MemoryReport report;
+        request_handler.ReportMemory(report);
+        report.Print(std::cerr);
+    }
+
+    try {
+        AddStatisticsRequestFromJson(request_handler, *doc);
+    }
+    catch (...) {
+        std::cerr << "Ошибка ввода json-файла"sv << std::endl;
+        return 0;
+    }
+    try {
+        PrintAnswerToJson(request_handler, std::cout, print_options);
+    }
+    catch (const std::exception& e) {
+        std::cout.flush();
+        std::cerr << "Ошибка формирования ответа: "sv << e.what() << std::endl;
+    }
+}
@@ -4,9 +4,32 @@
 namespace renderer {
 
 	void MapRenderer::SetMapSettings(MapSettings map_settings) {
+		map_settings_ = std::make_shared<const MapSettings>(std::move(map_settings));
+	}
+
+	void MapRenderer::SetMapSettings(std::shared_ptr<const MapSettings> map_settings) {
 		map_settings_ = std::move(map_settings);
 	}
 
+	const MapSettings& MapRenderer::GetMapSettings() const {
+		return *map_settings_;
+	}
+
+	const std::shared_ptr<const MapSettings>& MapRenderer::GetSharedMapSettings() const {
+		return map_settings_;
+	}
+
+	void MapRenderer::ReportMemory(memory::MemoryReport& report, const std::string& prefix) const {
+		size_t bytes = memory::HeapBytes(map_settings_->color_palette);
+		for (const svg::Color& color : map_settings_->color_palette) {
+			if (const auto* name = std::get_if<std::string>(&color)) {
+				bytes += memory::HeapBytes(*name);
+			}
+		}
+		// Разделяемые настройки учитываются в отчёте каждого отрисовщика, который на них ссылается
+		report.Add(prefix, "color_palette", bytes, map_settings_->color_palette.size());
+	}
+
 	svg::Color MapRenderer::GetRgbaColorFromJson(double ary_rgba[4]) const {
 		uint8_t r = static_cast<uint8_t>(ary_rgba[0]);
 		uint8_t g = static_cast<uint8_t>(ary_rgba[1]);
@@ -26,7 +49,7 @@ namespace renderer {
 
 	svg::Color MapRenderer::GetColorFromJsonNode(json::Node node) const {
 		if (node.IsString()) {
-			return node.AsString();
+			return std::string(node.AsString());
 		}
 		if (node.IsArray()) {
 			Array ar_node = node.AsArray();
@@ -62,7 +85,7 @@ namespace renderer {
 		}
 
 		const SphereProjector proj{ stop_coordinates.begin(), stop_coordinates.end(),
-				map_settings_.wight,map_settings_.height,map_settings_.padding };
+				map_settings_->wight,map_settings_->height,map_settings_->padding };
 
 		MapRenderBusPolyline(doc, buses, proj);
 		MapRenderBusNameText(doc, buses, proj);
@@ -73,16 +96,16 @@ namespace renderer {
 
 	void MapRenderer::MapRenderBusPolyline(svg::Document& doc, const std::vector<BusPtr>& buses, const SphereProjector& sph_proj) const {
 		int color_idx = 0;
-		int color_idx_max = map_settings_.color_palette.size();
+		int color_idx_max = map_settings_->color_palette.size();
 		for (auto& bus : buses) {
 			Polyline pl;
 
 			pl.SetFillColor("none");
-			Color fromArray = map_settings_.color_palette[color_idx];
+			Color fromArray = map_settings_->color_palette[color_idx];
 			pl.SetStrokeColor(fromArray);
 			pl.SetStrokeLineCap(StrokeLineCap::ROUND);
 			pl.SetStrokeLineJoin(StrokeLineJoin::ROUND);
-			pl.SetStrokeWidth(map_settings_.line_width);
+			pl.SetStrokeWidth(map_settings_->line_width);
 
 			for (const auto& stop : bus->busstop_info) {
 				const svg::Point screen_coord = sph_proj(stop->coordinates);
@@ -98,12 +121,12 @@ namespace renderer {
 
 	void MapRenderer::MapRenderBusNameText(svg::Document& doc, const std::vector<BusPtr>& buses, const SphereProjector& sph_proj) const {
 		int color_idx = 0;
-		int color_idx_max = map_settings_.color_palette.size();
+		int color_idx_max = map_settings_->color_palette.size();
 		for (auto& bus : buses) {
 			Text txt_m1;
 			Text txt_u1;
 			const svg::Point screen_coord = sph_proj(bus->busstop_info.front()->coordinates);
-			Color frompalette = map_settings_.color_palette[color_idx];
+			Color frompalette = map_settings_->color_palette[color_idx];
 
 			FillSettingsBusNameText(doc, bus->name, screen_coord, frompalette);
 
@@ -120,28 +143,28 @@ namespace renderer {
 		}
 	}
 
-	void MapRenderer::FillSettingsBusNameText(svg::Document& doc, const std::string& name, const svg::Point& point, const Color& color) const {
+	void MapRenderer::FillSettingsBusNameText(svg::Document& doc, std::string_view name, const svg::Point& point, const Color& color) const {
 		Text txt_m1;
 		Text txt_u1;
 		txt_u1.SetPosition(point);
-		txt_u1.SetOffset({ map_settings_.bus_label_offset[0],map_settings_.bus_label_offset[1] });
-		txt_u1.SetFontSize(map_settings_.bus_label_font_size);
+		txt_u1.SetOffset({ map_settings_->bus_label_offset[0],map_settings_->bus_label_offset[1] });
+		txt_u1.SetFontSize(map_settings_->bus_label_font_size);
 		txt_u1.SetFontFamily("Verdana");
 		txt_u1.SetFontWeight("bold");
-		txt_u1.SetData(name);
-		txt_u1.SetFillColor(map_settings_.underlayer_color);
-		txt_u1.SetStrokeColor(map_settings_.underlayer_color);
-		txt_u1.SetStrokeWidth(map_settings_.underlayer_width);
+		txt_u1.SetData(std::string(name));
+		txt_u1.SetFillColor(map_settings_->underlayer_color);
+		txt_u1.SetStrokeColor(map_settings_->underlayer_color);
+		txt_u1.SetStrokeWidth(map_settings_->underlayer_width);
 		txt_u1.SetStrokeLineCap(StrokeLineCap::ROUND);
 		txt_u1.SetStrokeLineJoin(StrokeLineJoin::ROUND);
 		doc.Add(txt_u1);
 
 		txt_m1.SetPosition(point);
-		txt_m1.SetOffset({ map_settings_.bus_label_offset[0],map_settings_.bus_label_offset[1] });
-		txt_m1.SetFontSize(map_settings_.bus_label_font_size);
+		txt_m1.SetOffset({ map_settings_->bus_label_offset[0],map_settings_->bus_label_offset[1] });
+		txt_m1.SetFontSize(map_settings_->bus_label_font_size);
 		txt_m1.SetFontFamily("Verdana");
 		txt_m1.SetFontWeight("bold");
-		txt_m1.SetData(name);
+		txt_m1.SetData(std::string(name));
 		txt_m1.SetFillColor(color);
 		doc.Add(txt_m1);
 	}
@@ -151,7 +174,7 @@ namespace renderer {
 			Circle cr;
 			const svg::Point screen_coord = sph_proj(stop->coordinates);
 			cr.SetCenter(screen_coord);
-			cr.SetRadius(map_settings_.stop_radius);
+			cr.SetRadius(map_settings_->stop_radius);
 			cr.SetFillColor("white");
 			doc.Add(cr);
 		}
@@ -163,26 +186,26 @@ namespace renderer {
 		}
 	}
 
-	void MapRenderer::FillSettingsStopNameText(svg::Document& doc, const std::string& name, const svg::Point& point, const Color& color) const {
+	void MapRenderer::FillSettingsStopNameText(svg::Document& doc, std::string_view name, const svg::Point& point, const Color& color) const {
 		Text txt_m1;
 		Text txt_u1;
 		txt_u1.SetPosition(point);
-		txt_u1.SetOffset({ map_settings_.stop_label_offset[0],map_settings_.stop_label_offset[1] });
-		txt_u1.SetFontSize(map_settings_.stop_label_font_size);
+		txt_u1.SetOffset({ map_settings_->stop_label_offset[0],map_settings_->stop_label_offset[1] });
+		txt_u1.SetFontSize(map_settings_->stop_label_font_size);
 		txt_u1.SetFontFamily("Verdana");
-		txt_u1.SetData(name);
-		txt_u1.SetFillColor(map_settings_.underlayer_color);
-		txt_u1.SetStrokeColor(map_settings_.underlayer_color);
-		txt_u1.SetStrokeWidth(map_settings_.underlayer_width);
+		txt_u1.SetData(std::string(name));
+		txt_u1.SetFillColor(map_settings_->underlayer_color);
+		txt_u1.SetStrokeColor(map_settings_->underlayer_color);
+		txt_u1.SetStrokeWidth(map_settings_->underlayer_width);
 		txt_u1.SetStrokeLineCap(StrokeLineCap::ROUND);
 		txt_u1.SetStrokeLineJoin(StrokeLineJoin::ROUND);
 		doc.Add(txt_u1);
 
 		txt_m1.SetPosition(point);
-		txt_m1.SetOffset({ map_settings_.stop_label_offset[0],map_settings_.stop_label_offset[1] });
-		txt_m1.SetFontSize(map_settings_.stop_label_font_size);
+		txt_m1.SetOffset({ map_settings_->stop_label_offset[0],map_settings_->stop_label_offset[1] });
+		txt_m1.SetFontSize(map_settings_->stop_label_font_size);
 		txt_m1.SetFontFamily("Verdana");
-		txt_m1.SetData(name);
+		txt_m1.SetData(std::string(name));
 		txt_m1.SetFillColor(color);
 		doc.Add(txt_m1);
 	}
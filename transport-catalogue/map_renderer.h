@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <vector>
 #include <set>
@@ -114,9 +115,15 @@ namespace renderer {
     class MapRenderer {
     public:
         MapRenderer() = default;
-        MapRenderer(MapSettings map_settings) : map_settings_(map_settings) {};
+        MapRenderer(MapSettings map_settings) : map_settings_(std::make_shared<const MapSettings>(std::move(map_settings))) {};
+        // Настройки неизменяемы и могут разделяться между отрисовщиками нескольких справочников
+        explicit MapRenderer(std::shared_ptr<const MapSettings> map_settings) : map_settings_(std::move(map_settings)) {};
 
         void SetMapSettings(MapSettings map_settings);
+        void SetMapSettings(std::shared_ptr<const MapSettings> map_settings);
+        const MapSettings& GetMapSettings() const;
+        const std::shared_ptr<const MapSettings>& GetSharedMapSettings() const;
+        void ReportMemory(memory::MemoryReport& report, const std::string& prefix) const;
         svg::Color GetRgbaColorFromJson(double ary_rgba[4]) const;
         svg::Color GetRgbColorFromJson(int ary_rgba[3]) const;
         svg::Color GetColorFromJsonNode(json::Node node) const;
@@ -125,11 +132,11 @@ namespace renderer {
         svg::Document MapRenderBusTrip(const std::vector<BusPtr>& buses, const vector<StopPtr>& stops) const;
         void MapRenderBusPolyline(svg::Document& doc, const std::vector<BusPtr>& buses, const SphereProjector& sph_proj) const;
 		void MapRenderBusNameText(svg::Document& doc, const std::vector<BusPtr>& buses, const SphereProjector& sph_proj) const;
-		void FillSettingsBusNameText(svg::Document& doc, const std::string& name, const svg::Point& point, const Color& color) const;
+		void FillSettingsBusNameText(svg::Document& doc, std::string_view name, const svg::Point& point, const Color& color) const;
 		void MapRenderStopCircleName(svg::Document& doc, const vector<StopPtr>& stops, const SphereProjector& sph_proj) const;
-		void FillSettingsStopNameText(svg::Document& doc, const std::string& name, const svg::Point& point, const Color& color) const;
+		void FillSettingsStopNameText(svg::Document& doc, std::string_view name, const svg::Point& point, const Color& color) const;
 
     private:
-        MapSettings map_settings_;
+        std::shared_ptr<const MapSettings> map_settings_ = std::make_shared<const MapSettings>();
     };
 }
\ No newline at end of file
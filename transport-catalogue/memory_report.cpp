@@ -0,0 +1,33 @@
+#include "memory_report.h"
+
+#include <iomanip>
+#include <ostream>
+
+namespace memory {
+
+	void MemoryReport::Add(const std::string& prefix, const std::string& name, size_t bytes, size_t count) {
+		items_.push_back({ prefix + "." + name, bytes, count });
+	}
+
+	const std::vector<MemoryUsage>& MemoryReport::GetItems() const {
+		return items_;
+	}
+
+	size_t MemoryReport::GetTotalBytes() const {
+		size_t total = 0;
+		for (const MemoryUsage& item : items_) {
+			total += item.bytes;
+		}
+		return total;
+	}
+
+	void MemoryReport::Print(std::ostream& output) const {
+		for (const MemoryUsage& item : items_) {
+			output << std::left << std::setw(40) << item.name
+				<< std::right << std::setw(14) << item.bytes << " bytes"
+				<< std::setw(12) << item.count << " items\n";
+		}
+		output << std::left << std::setw(40) << "total"
+			<< std::right << std::setw(14) << GetTotalBytes() << " bytes" << std::endl;
+	}
+}
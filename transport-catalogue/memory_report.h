@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace memory {
+
+	struct MemoryUsage {
+		std::string name;
+		size_t bytes = 0;
+		size_t count = 0;
+	};
+
+	// Отчёт о памяти, занятой контейнерами. Каждый компонент добавляет свои строки через ReportMemory(report, prefix),
+	// имя строки - prefix + "." + имя контейнера.
+	// Байты - оценка кучи по ёмкости контейнеров и типовым накладным расходам узлов (libstdc++), без учёта аллокатора.
+	class MemoryReport {
+	public:
+		void Add(const std::string& prefix, const std::string& name, size_t bytes, size_t count);
+
+		const std::vector<MemoryUsage>& GetItems() const;
+		size_t GetTotalBytes() const;
+		void Print(std::ostream& output) const;
+
+	private:
+		std::vector<MemoryUsage> items_;
+	};
+
+	// Память строки вне объекта; короткие строки хранятся внутри std::string
+	inline size_t HeapBytes(const std::string& value) {
+		const char* begin = reinterpret_cast<const char*>(&value);
+		const bool is_local = value.data() >= begin && value.data() < begin + sizeof(value);
+		return is_local ? 0 : value.capacity() + 1;
+	}
+
+	template <typename T, typename Allocator>
+	size_t HeapBytes(const std::vector<T, Allocator>& values) {
+		return values.capacity() * sizeof(T);
+	}
+
+	template <typename T>
+	size_t HeapBytes(const std::deque<T>& values) {
+		// deque выделяет блоки по 512 байт (или по одному элементу для крупных типов) и массив указателей на них
+		constexpr size_t BLOCK_BYTES = 512;
+		constexpr size_t per_block = sizeof(T) < BLOCK_BYTES ? BLOCK_BYTES / sizeof(T) : 1;
+		const size_t blocks = values.size() / per_block + 1;
+		return blocks * (per_block * sizeof(T) + sizeof(void*));
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Equal>
+	size_t HeapBytes(const std::unordered_map<Key, Value, Hash, Equal>& values) {
+		// Узел: указатель на следующий, пара и сохранённый хеш
+		const size_t node_bytes = sizeof(void*) + sizeof(std::pair<const Key, Value>) + sizeof(size_t);
+		return values.bucket_count() * sizeof(void*) + values.size() * node_bytes;
+	}
+
+	template <typename Key, typename Value, typename Compare>
+	size_t HeapBytes(const std::map<Key, Value, Compare>& values) {
+		// Узел красно-чёрного дерева: цвет и три указателя
+		const size_t node_bytes = 4 * sizeof(void*) + sizeof(std::pair<const Key, Value>);
+		return values.size() * node_bytes;
+	}
+}
@@ -0,0 +1,463 @@
+#include "name_index.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace transportcatalogue {
+
+	namespace {
+		char32_t FoldCase(char32_t c) {
+			if (c >= U'A' && c <= U'Z') {
+				return c + (U'a' - U'A');
+			}
+			if (c >= U'А' && c <= U'Я') {
+				return c + (U'а' - U'А');
+			}
+			if (c == U'Ё' || c == U'ё') {
+				return U'е';
+			}
+			// Ѐ..Џ (украинские, белорусские и сербские буквы) -> ѐ..џ
+			if (c >= 0x0400 && c <= 0x040F) {
+				return c + 0x50;
+			}
+			return c;
+		}
+
+		bool IsContinuation(unsigned char c) {
+			return (c & 0xC0) == 0x80;
+		}
+
+		bool CompareByRelevance(const NameSearchIndex::Match& lhs, const NameSearchIndex::Match& rhs) {
+			if (lhs.distance != rhs.distance) {
+				return lhs.distance < rhs.distance;
+			}
+			if (lhs.entry->weight != rhs.entry->weight) {
+				return lhs.entry->weight > rhs.entry->weight;
+			}
+			if (lhs.entry->name != rhs.entry->name) {
+				return lhs.entry->name < rhs.entry->name;
+			}
+			return lhs.entry->kind < rhs.entry->kind;
+		}
+
+		size_t EditDistance(const std::u32string& lhs, const std::u32string& rhs) {
+			std::vector<size_t> row(rhs.size() + 1);
+			std::iota(row.begin(), row.end(), 0);
+			for (size_t i = 1; i <= lhs.size(); ++i) {
+				size_t diagonal = row[0];
+				row[0] = i;
+				for (size_t j = 1; j <= rhs.size(); ++j) {
+					const size_t replace = diagonal + (lhs[i - 1] == rhs[j - 1] ? 0 : 1);
+					diagonal = row[j];
+					row[j] = std::min({ row[j] + 1, row[j - 1] + 1, replace });
+				}
+			}
+			return row.back();
+		}
+	}
+
+	std::u32string NameSearchIndex::Normalize(std::string_view name) {
+		std::u32string result;
+		result.reserve(name.size());
+		size_t pos = 0;
+		while (pos < name.size()) {
+			const unsigned char lead = static_cast<unsigned char>(name[pos]);
+			size_t length = 1;
+			char32_t code = lead;
+			if (lead >= 0xF0 && lead < 0xF8) {
+				length = 4;
+				code = lead & 0x07;
+			}
+			else if (lead >= 0xE0) {
+				length = lead < 0xF0 ? 3 : 1;
+				code = lead & 0x0F;
+			}
+			else if (lead >= 0xC0) {
+				length = 2;
+				code = lead & 0x1F;
+			}
+
+			bool valid = length > 1 && pos + length <= name.size();
+			for (size_t i = 1; valid && i < length; ++i) {
+				const unsigned char next = static_cast<unsigned char>(name[pos + i]);
+				valid = IsContinuation(next);
+				code = (code << 6) | (next & 0x3F);
+			}
+			// Некорректная последовательность учитывается побайтно
+			if (!valid) {
+				length = 1;
+				code = lead;
+			}
+
+			result.push_back(FoldCase(code));
+			pos += length;
+		}
+		return result;
+	}
+
+	void NameSearchIndex::Build(std::vector<Entry> entries) {
+		Clear();
+		std::vector<std::u32string> keys;
+		keys.reserve(entries.size());
+		for (const Entry& entry : entries) {
+			keys.push_back(Normalize(entry.name));
+		}
+
+		std::vector<uint32_t> order(entries.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+			if (keys[lhs] != keys[rhs]) {
+				return keys[lhs] < keys[rhs];
+			}
+			return entries[lhs].name != entries[rhs].name
+				? entries[lhs].name < entries[rhs].name
+				: entries[lhs].kind < entries[rhs].kind;
+			});
+
+		std::vector<std::u32string> sorted_keys;
+		sorted_keys.reserve(keys.size());
+		entries_.reserve(entries.size());
+		for (uint32_t id : order) {
+			sorted_keys.push_back(std::move(keys[id]));
+			entries_.push_back(entries[id]);
+		}
+
+		// Корень есть и у пустого индекса: в собранный индекс можно добавлять записи
+		BuildNode(sorted_keys, 0, static_cast<uint32_t>(sorted_keys.size()), 0);
+		BuildTopCache();
+		removed_.assign(entries_.size(), 0);
+		nodes_.shrink_to_fit();
+		edge_labels_.shrink_to_fit();
+		edge_targets_.shrink_to_fit();
+	}
+
+	uint32_t NameSearchIndex::BuildNode(const std::vector<std::u32string>& keys, uint32_t begin, uint32_t end, size_t depth) {
+		const uint32_t node_id = static_cast<uint32_t>(nodes_.size());
+		nodes_.emplace_back();
+
+		uint32_t terminal_end = begin;
+		while (terminal_end < end && keys[terminal_end].size() == depth) {
+			++terminal_end;
+		}
+
+		// Сначала резервируем рёбра узла подряд, затем достраиваем детей
+		std::vector<uint32_t> group_begins;
+		for (uint32_t i = terminal_end; i < end; ++i) {
+			if (i == terminal_end || keys[i][depth] != keys[i - 1][depth]) {
+				group_begins.push_back(i);
+			}
+		}
+		const uint32_t first_edge = static_cast<uint32_t>(edge_labels_.size());
+		for (uint32_t group_begin : group_begins) {
+			edge_labels_.push_back(keys[group_begin][depth]);
+			edge_targets_.push_back(0);
+		}
+
+		nodes_[node_id] = { first_edge, static_cast<uint32_t>(group_begins.size()), begin, terminal_end, end, NO_TOP_CACHE, 0 };
+
+		for (size_t g = 0; g < group_begins.size(); ++g) {
+			const uint32_t group_end = g + 1 < group_begins.size() ? group_begins[g + 1] : end;
+			const uint32_t child = BuildNode(keys, group_begins[g], group_end, depth + 1);
+			edge_targets_[first_edge + g] = child;
+		}
+		return node_id;
+	}
+
+	void NameSearchIndex::BuildTopCache() {
+		std::vector<Match> matches;
+		for (Node& node : nodes_) {
+			if (node.entry_end - node.entry_begin <= TOP_CACHE_THRESHOLD) {
+				continue;
+			}
+			matches.clear();
+			for (uint32_t i = node.entry_begin; i < node.entry_end; ++i) {
+				matches.push_back({ &entries_[i], 0 });
+			}
+			std::partial_sort(matches.begin(), matches.begin() + TOP_CACHE_SIZE, matches.end(), CompareByRelevance);
+			node.top_begin = static_cast<uint32_t>(top_entries_.size());
+			node.top_count = static_cast<uint32_t>(TOP_CACHE_SIZE);
+			for (size_t i = 0; i < TOP_CACHE_SIZE; ++i) {
+				top_entries_.push_back(static_cast<uint32_t>(matches[i].entry - entries_.data()));
+			}
+		}
+		top_entries_.shrink_to_fit();
+	}
+
+	void NameSearchIndex::Clear() {
+		top_entries_.clear();
+		entries_.clear();
+		nodes_.clear();
+		edge_labels_.clear();
+		edge_targets_.clear();
+		removed_.clear();
+		removed_count_ = 0;
+		delta_.clear();
+	}
+
+	bool NameSearchIndex::IsBuilt() const {
+		return !nodes_.empty();
+	}
+
+	void NameSearchIndex::Insert(const Entry& entry) {
+		if (!IsBuilt()) {
+			return;
+		}
+		DeltaEntry item{ Normalize(entry.name), entry };
+		const auto itr = std::upper_bound(delta_.begin(), delta_.end(), item, [](const DeltaEntry& lhs, const DeltaEntry& rhs) {
+			return lhs.key < rhs.key;
+			});
+		delta_.insert(itr, std::move(item));
+		CompactIfNeeded();
+	}
+
+	void NameSearchIndex::Erase(std::string_view name, Kind kind) {
+		if (!IsBuilt()) {
+			return;
+		}
+		const std::u32string key = Normalize(name);
+		if (const auto itr = FindDeltaEntry(key, name, kind); itr != delta_.end()) {
+			delta_.erase(itr);
+			return;
+		}
+		const uint32_t entry_id = FindEntry(key, name, kind);
+		if (entry_id == NO_ENTRY) {
+			return;
+		}
+		removed_[entry_id] = 1;
+		++removed_count_;
+		UpdateTopCaches(key, entry_id, true);
+		CompactIfNeeded();
+	}
+
+	void NameSearchIndex::SetWeight(std::string_view name, Kind kind, size_t weight) {
+		if (!IsBuilt()) {
+			return;
+		}
+		const std::u32string key = Normalize(name);
+		if (const auto itr = FindDeltaEntry(key, name, kind); itr != delta_.end()) {
+			itr->entry.weight = weight;
+			return;
+		}
+		const uint32_t entry_id = FindEntry(key, name, kind);
+		if (entry_id == NO_ENTRY || entries_[entry_id].weight == weight) {
+			return;
+		}
+		entries_[entry_id].weight = weight;
+		UpdateTopCaches(key, entry_id, false);
+	}
+
+	uint32_t NameSearchIndex::FindEntry(const std::u32string& key, std::string_view name, Kind kind) const {
+		const Node* node = FindNode(key);
+		if (node == nullptr) {
+			return NO_ENTRY;
+		}
+		for (uint32_t i = node->entry_begin; i < node->terminal_end; ++i) {
+			if (!removed_[i] && entries_[i].kind == kind && entries_[i].name == name) {
+				return i;
+			}
+		}
+		return NO_ENTRY;
+	}
+
+	std::vector<NameSearchIndex::DeltaEntry>::iterator NameSearchIndex::FindDeltaEntry(const std::u32string& key, std::string_view name, Kind kind) {
+		auto itr = std::lower_bound(delta_.begin(), delta_.end(), key, [](const DeltaEntry& item, const std::u32string& value) {
+			return item.key < value;
+			});
+		for (; itr != delta_.end() && itr->key == key; ++itr) {
+			if (itr->entry.kind == kind && itr->entry.name == name) {
+				return itr;
+			}
+		}
+		return delta_.end();
+	}
+
+	void NameSearchIndex::UpdateTopCaches(const std::u32string& key, uint32_t entry_id, bool removed) {
+		// Кеш есть только у крупных поддеревьев, поэтому ниже первого узла без кеша их нет
+		Node* node = &nodes_.front();
+		for (size_t depth = 0; node->top_begin != NO_TOP_CACHE; ++depth) {
+			UpdateTopCache(*node, entry_id, removed);
+			if (depth == key.size()) {
+				break;
+			}
+			const auto labels_begin = edge_labels_.begin() + node->first_edge;
+			const auto itr = std::lower_bound(labels_begin, labels_begin + node->edge_count, key[depth]);
+			node = &nodes_[edge_targets_[itr - edge_labels_.begin()]];
+		}
+	}
+
+	void NameSearchIndex::UpdateTopCache(Node& node, uint32_t entry_id, bool removed) {
+		const auto better = [this](uint32_t lhs, uint32_t rhs) {
+			return CompareByRelevance({ &entries_[lhs], 0 }, { &entries_[rhs], 0 });
+		};
+		const auto begin = top_entries_.begin() + node.top_begin;
+		auto end = begin + node.top_count;
+		if (const auto itr = std::find(begin, end, entry_id); itr != end) {
+			// Остальные записи кеша по-прежнему не хуже всех записей вне его
+			std::move(itr + 1, end, itr);
+			--end;
+			--node.top_count;
+		}
+		// Запись лучше худшей в кеше не хуже и всех записей вне кеша, поэтому её можно вернуть в кеш.
+		// Иначе кеш просто становится короче; он восстановится при пересборке дерева
+		if (removed || node.top_count == 0 || !better(entry_id, *(end - 1))) {
+			return;
+		}
+		if (node.top_count == TOP_CACHE_SIZE) {
+			--end;
+		}
+		else {
+			++node.top_count;
+		}
+		const auto pos = std::upper_bound(begin, end, entry_id, better);
+		std::move_backward(pos, end, end + 1);
+		*pos = entry_id;
+	}
+
+	void NameSearchIndex::CompactIfNeeded() {
+		if (delta_.size() + removed_count_ <= std::max(DELTA_MIN, entries_.size() / DELTA_RATIO)) {
+			return;
+		}
+		std::vector<Entry> entries;
+		entries.reserve(entries_.size() - removed_count_ + delta_.size());
+		for (size_t i = 0; i < entries_.size(); ++i) {
+			if (!removed_[i]) {
+				entries.push_back(entries_[i]);
+			}
+		}
+		for (const DeltaEntry& item : delta_) {
+			entries.push_back(item.entry);
+		}
+		Build(std::move(entries));
+	}
+
+	size_t NameSearchIndex::GetNodeCount() const {
+		return nodes_.size();
+	}
+
+	void NameSearchIndex::ReportMemory(memory::MemoryReport& report, const std::string& prefix) const {
+		report.Add(prefix, "entries", memory::HeapBytes(entries_) + memory::HeapBytes(removed_), entries_.size() - removed_count_);
+		report.Add(prefix, "nodes", memory::HeapBytes(nodes_), nodes_.size());
+		report.Add(prefix, "edges", memory::HeapBytes(edge_labels_) + memory::HeapBytes(edge_targets_), edge_labels_.size());
+		report.Add(prefix, "top_cache", memory::HeapBytes(top_entries_), top_entries_.size());
+		size_t delta_bytes = memory::HeapBytes(delta_);
+		for (const DeltaEntry& item : delta_) {
+			delta_bytes += item.key.capacity() * sizeof(char32_t);
+		}
+		report.Add(prefix, "delta", delta_bytes, delta_.size());
+	}
+
+	const NameSearchIndex::Node* NameSearchIndex::FindNode(const std::u32string& key) const {
+		if (!IsBuilt()) {
+			return nullptr;
+		}
+		const Node* node = &nodes_.front();
+		for (char32_t c : key) {
+			const auto labels_begin = edge_labels_.begin() + node->first_edge;
+			const auto labels_end = labels_begin + node->edge_count;
+			const auto itr = std::lower_bound(labels_begin, labels_end, c);
+			if (itr == labels_end || *itr != c) {
+				return nullptr;
+			}
+			node = &nodes_[edge_targets_[itr - edge_labels_.begin()]];
+		}
+		return node;
+	}
+
+	std::vector<NameSearchIndex::Match> NameSearchIndex::FindByPrefix(std::string_view prefix, size_t limit) const {
+		std::vector<Match> result;
+		if (limit == 0) {
+			return result;
+		}
+		const std::u32string key = Normalize(prefix);
+		const Node* node = FindNode(key);
+		// Без узла в дереве имена с этим префиксом могут быть только в дополнении
+		if (node != nullptr && node->top_begin != NO_TOP_CACHE && limit <= node->top_count) {
+			for (size_t i = 0; i < limit; ++i) {
+				result.push_back({ &entries_[top_entries_[node->top_begin + i]], 0 });
+			}
+		}
+		else if (node != nullptr) {
+			result.reserve(node->entry_end - node->entry_begin);
+			for (uint32_t i = node->entry_begin; i < node->entry_end; ++i) {
+				if (!removed_[i]) {
+					result.push_back({ &entries_[i], 0 });
+				}
+			}
+		}
+
+		// Ключи дополнения с этим префиксом идут подряд
+		auto itr = std::lower_bound(delta_.begin(), delta_.end(), key, [](const DeltaEntry& item, const std::u32string& value) {
+			return item.key < value;
+			});
+		for (; itr != delta_.end() && itr->key.compare(0, key.size(), key) == 0; ++itr) {
+			result.push_back({ &itr->entry, 0 });
+		}
+
+		if (result.size() > limit) {
+			std::partial_sort(result.begin(), result.begin() + limit, result.end(), CompareByRelevance);
+			result.resize(limit);
+		}
+		else {
+			std::sort(result.begin(), result.end(), CompareByRelevance);
+		}
+		return result;
+	}
+
+	std::vector<NameSearchIndex::Match> NameSearchIndex::FindFuzzy(std::string_view query, size_t max_distance, size_t limit) const {
+		std::vector<Match> result;
+		if (!IsBuilt() || limit == 0) {
+			return result;
+		}
+		max_distance = std::min(max_distance, MAX_EDIT_DISTANCE);
+
+		const std::u32string key = Normalize(query);
+		// Строки матрицы Левенштейна для каждой глубины обхода лежат подряд в одном буфере
+		std::vector<size_t> rows(key.size() + 1);
+		std::iota(rows.begin(), rows.end(), 0);
+		CollectFuzzy(0, key, max_distance, rows, 0, result);
+		for (const DeltaEntry& item : delta_) {
+			if (const size_t distance = EditDistance(key, item.key); distance <= max_distance) {
+				result.push_back({ &item.entry, distance });
+			}
+		}
+
+		std::sort(result.begin(), result.end(), CompareByRelevance);
+		if (result.size() > limit) {
+			result.resize(limit);
+		}
+		return result;
+	}
+
+	void NameSearchIndex::CollectFuzzy(uint32_t node_id, const std::u32string& query, size_t max_distance,
+		std::vector<size_t>& rows, size_t depth, std::vector<Match>& result) const {
+		const Node& node = nodes_[node_id];
+		const size_t width = query.size() + 1;
+
+		const size_t distance = rows[depth * width + query.size()];
+		if (distance <= max_distance) {
+			for (uint32_t i = node.entry_begin; i < node.terminal_end; ++i) {
+				if (!removed_[i]) {
+					result.push_back({ &entries_[i], distance });
+				}
+			}
+		}
+
+		rows.resize((depth + 2) * width);
+		for (uint32_t e = node.first_edge; e < node.first_edge + node.edge_count; ++e) {
+			const char32_t c = edge_labels_[e];
+			const size_t* prev = rows.data() + depth * width;
+			size_t* row = rows.data() + (depth + 1) * width;
+			row[0] = prev[0] + 1;
+			size_t row_min = row[0];
+			for (size_t j = 1; j < width; ++j) {
+				const size_t replace = prev[j - 1] + (query[j - 1] == c ? 0 : 1);
+				row[j] = std::min({ prev[j] + 1, row[j - 1] + 1, replace });
+				row_min = std::min(row_min, row[j]);
+			}
+			// Дальше по ветке расстояние не уменьшится
+			if (row_min <= max_distance) {
+				CollectFuzzy(edge_targets_[e], query, max_distance, rows, depth + 1, result);
+			}
+		}
+	}
+}
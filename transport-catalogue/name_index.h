@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "memory_report.h"
+
+namespace transportcatalogue {
+
+	// Префиксное дерево по нормализованным именам остановок и автобусов для автодополнения.
+	// Имена разбираются как UTF-8 и сравниваются по кодовым точкам без учёта регистра (латиница и кириллица, ё = е).
+	// Дерево собирается один раз по отсортированным ключам и хранится плоско: узлы в порядке обхода в глубину,
+	// рёбра узла лежат подряд, поэтому записи поддерева - непрерывный диапазон отсортированного массива записей.
+	// Изменения после сборки не трогают дерево: удалённые записи помечаются, новые имена копятся в небольшом
+	// отсортированном дополнении, которое запросы просматривают вместе с деревом; дерево пересобирается,
+	// когда изменений становится больше доли от числа записей.
+	class NameSearchIndex {
+	public:
+		enum class Kind : uint8_t {
+			STOP,
+			BUS
+		};
+
+		struct Entry {
+			// Ссылается на имя в справочнике, которое живёт дольше записи
+			std::string_view name;
+			Kind kind = Kind::STOP;
+			// Релевантность: для остановки - число автобусов через неё, для автобуса - число его уникальных остановок
+			size_t weight = 0;
+		};
+
+		struct Match {
+			const Entry* entry = nullptr;
+			size_t distance = 0;
+		};
+
+		static constexpr size_t MAX_EDIT_DISTANCE = 3;
+		// Для узлов с большим поддеревом лучшие записи считаются заранее: короткий префикс не перебирает тысячи имён
+		static constexpr size_t TOP_CACHE_SIZE = 32;
+		static constexpr size_t TOP_CACHE_THRESHOLD = 256;
+		// Дерево пересобирается, когда новых и удалённых записей больше max(DELTA_MIN, размер / DELTA_RATIO)
+		static constexpr size_t DELTA_MIN = 64;
+		static constexpr size_t DELTA_RATIO = 16;
+
+		void Build(std::vector<Entry> entries);
+		void Clear();
+		bool IsBuilt() const;
+
+		// Точечные изменения собранного индекса; до Build ничего не делают
+		void Insert(const Entry& entry);
+		void Erase(std::string_view name, Kind kind);
+		void SetWeight(std::string_view name, Kind kind, size_t weight);
+
+		// Имена, начинающиеся с prefix, по убыванию веса, затем по имени
+		std::vector<Match> FindByPrefix(std::string_view prefix, size_t limit) const;
+		// Имена на расстоянии Левенштейна не больше max_distance (ограничено MAX_EDIT_DISTANCE)
+		// по возрастанию расстояния, затем по убыванию веса и по имени
+		std::vector<Match> FindFuzzy(std::string_view query, size_t max_distance, size_t limit) const;
+
+		size_t GetNodeCount() const;
+		void ReportMemory(memory::MemoryReport& report, const std::string& prefix) const;
+
+		static std::u32string Normalize(std::string_view name);
+
+	private:
+		static constexpr uint32_t NO_TOP_CACHE = UINT32_MAX;
+		static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+		struct Node {
+			uint32_t first_edge = 0;
+			uint32_t edge_count = 0;
+			// Записи поддерева [entry_begin, entry_end); записи, оканчивающиеся в узле, - [entry_begin, terminal_end)
+			uint32_t entry_begin = 0;
+			uint32_t terminal_end = 0;
+			uint32_t entry_end = 0;
+			// Начало TOP_CACHE_SIZE мест под лучшие записи поддерева в top_entries_ или NO_TOP_CACHE.
+			// Занятые top_count мест - по убыванию релевантности, и любая другая живая запись поддерева не лучше их
+			uint32_t top_begin = NO_TOP_CACHE;
+			uint32_t top_count = 0;
+		};
+
+		struct DeltaEntry {
+			std::u32string key;
+			Entry entry;
+		};
+
+		uint32_t BuildNode(const std::vector<std::u32string>& keys, uint32_t begin, uint32_t end, size_t depth);
+		void BuildTopCache();
+		const Node* FindNode(const std::u32string& key) const;
+		// Номер живой записи дерева или NO_ENTRY
+		uint32_t FindEntry(const std::u32string& key, std::string_view name, Kind kind) const;
+		std::vector<DeltaEntry>::iterator FindDeltaEntry(const std::u32string& key, std::string_view name, Kind kind);
+		// Поправляет кеши лучших записей на пути к записи entry_id после смены её веса или удаления
+		void UpdateTopCaches(const std::u32string& key, uint32_t entry_id, bool removed);
+		void UpdateTopCache(Node& node, uint32_t entry_id, bool removed);
+		void CompactIfNeeded();
+		void CollectFuzzy(uint32_t node_id, const std::u32string& query, size_t max_distance,
+			std::vector<size_t>& rows, size_t depth, std::vector<Match>& result) const;
+
+	private:
+		std::vector<Entry> entries_;
+		std::vector<Node> nodes_;
+		std::vector<char32_t> edge_labels_;
+		std::vector<uint32_t> edge_targets_;
+		std::vector<uint32_t> top_entries_;
+		std::vector<uint8_t> removed_;
+		size_t removed_count_ = 0;
+		// Записи, добавленные после Build, по возрастанию ключа
+		std::vector<DeltaEntry> delta_;
+	};
+}
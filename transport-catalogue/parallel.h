@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+	// Число потоков для ParallelFor: по числу ядер, но не меньше одного
+	inline size_t GetThreadCount() {
+		return std::max<size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	// Делит [0, count) на непрерывные куски не короче min_chunk и вызывает func(begin, end) для каждого куска
+	// в отдельном потоке; последний кусок выполняется в вызывающем потоке.
+	// Куски не пересекаются, поэтому func может без синхронизации писать в элементы своего диапазона.
+	// Первое исключение из func пробрасывается после завершения всех потоков.
+	template <typename Func>
+	void ParallelFor(size_t count, size_t min_chunk, Func&& func) {
+		if (count == 0) {
+			return;
+		}
+		const size_t chunks = std::clamp<size_t>(count / std::max<size_t>(min_chunk, 1), 1, GetThreadCount());
+		if (chunks == 1) {
+			func(size_t{ 0 }, count);
+			return;
+		}
+
+		const size_t chunk_size = (count + chunks - 1) / chunks;
+		std::vector<std::exception_ptr> errors(chunks);
+		std::vector<std::thread> threads;
+		threads.reserve(chunks - 1);
+
+		auto run = [&](size_t chunk) {
+			const size_t begin = chunk * chunk_size;
+			const size_t end = std::min(count, begin + chunk_size);
+			try {
+				if (begin < end) {
+					func(begin, end);
+				}
+			}
+			catch (...) {
+				errors[chunk] = std::current_exception();
+			}
+		};
+
+		for (size_t chunk = 0; chunk + 1 < chunks; ++chunk) {
+			threads.emplace_back(run, chunk);
+		}
+		run(chunks - 1);
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+
+		for (const std::exception_ptr& error : errors) {
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+	}
+}
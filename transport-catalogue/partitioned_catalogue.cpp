@@ -0,0 +1,58 @@
+#include "partitioned_catalogue.h"
+
+namespace transportcatalogue {
+
+	PartitionedCatalogue::RegionId PartitionedCatalogue::AddRegion(std::string id, std::string name_prefix) {
+		auto region = std::make_unique<Region>();
+		region->id = std::move(id);
+		region->name_prefix = std::move(name_prefix);
+		regions_.push_back(std::move(region));
+		return regions_.size() - 1;
+	}
+
+	size_t PartitionedCatalogue::GetRegionCount() const {
+		return regions_.size();
+	}
+
+	std::optional<PartitionedCatalogue::RegionId> PartitionedCatalogue::FindRegion(std::string_view id) const {
+		for (RegionId region = 0; region < regions_.size(); ++region) {
+			if (regions_[region]->id == id) {
+				return region;
+			}
+		}
+		return std::nullopt;
+	}
+
+	std::optional<PartitionedCatalogue::RegionId> PartitionedCatalogue::FindRegionByName(std::string_view name) const {
+		std::optional<RegionId> result;
+		size_t best_length = 0;
+		for (RegionId region = 0; region < regions_.size(); ++region) {
+			const std::string& prefix = regions_[region]->name_prefix;
+			if (name.substr(0, prefix.size()) == prefix && (!result || prefix.size() > best_length)) {
+				result = region;
+				best_length = prefix.size();
+			}
+		}
+		return result;
+	}
+
+	const std::string& PartitionedCatalogue::GetRegionName(RegionId region) const {
+		return regions_.at(region)->id;
+	}
+
+	void PartitionedCatalogue::SetMapSettings(std::shared_ptr<const renderer::MapSettings> map_settings) {
+		map_settings_ = std::move(map_settings);
+	}
+
+	const std::shared_ptr<const renderer::MapSettings>& PartitionedCatalogue::GetMapSettings() const {
+		return map_settings_;
+	}
+
+	SnapshotStore::Handle PartitionedCatalogue::Pin(RegionId region) const {
+		return regions_.at(region)->store.Pin();
+	}
+
+	uint64_t PartitionedCatalogue::GetRegionVersion(RegionId region) const {
+		return regions_.at(region)->store.GetCurrentVersion();
+	}
+}
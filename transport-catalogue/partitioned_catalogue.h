@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "catalogue_snapshot.h"
+#include "parallel.h"
+
+namespace transportcatalogue {
+
+	// Несколько независимых регионов в одном процессе. У каждого региона своё хранилище версий
+	// (справочник, граф и маршрутизатор), поэтому обновление одного региона не задерживает запросы к другим.
+	// Неизменяемые настройки отрисовки хранятся в одном экземпляре и разделяются всеми регионами.
+	class PartitionedCatalogue {
+	public:
+		using RegionId = size_t;
+
+		// name_prefix - префикс имён остановок и автобусов региона, по нему запрос без явного региона
+		// направляется в регион; пустой префикс означает регион по умолчанию
+		RegionId AddRegion(std::string id, std::string name_prefix);
+		size_t GetRegionCount() const;
+
+		std::optional<RegionId> FindRegion(std::string_view id) const;
+		// Регион с самым длинным префиксом, с которого начинается name
+		std::optional<RegionId> FindRegionByName(std::string_view name) const;
+		const std::string& GetRegionName(RegionId region) const;
+
+		void SetMapSettings(std::shared_ptr<const renderer::MapSettings> map_settings);
+		const std::shared_ptr<const renderer::MapSettings>& GetMapSettings() const;
+
+		SnapshotStore::Handle Pin(RegionId region) const;
+		uint64_t GetRegionVersion(RegionId region) const;
+
+		// Собирает и публикует первые версии всех регионов параллельно.
+		// builder(region, snapshot) заполняет справочник и настройки маршрутов, граф строится после него.
+		template <typename Builder>
+		void BuildAll(Builder&& builder);
+
+		// Copy-on-write обновление одного региона, см. SnapshotStore::Update
+		template <typename Updater>
+		uint64_t Update(RegionId region, Updater&& updater);
+
+	private:
+		struct Region {
+			std::string id;
+			std::string name_prefix;
+			SnapshotStore store;
+		};
+
+	private:
+		// SnapshotStore неперемещаемый, регионы хранятся по указателю
+		std::vector<std::unique_ptr<Region>> regions_;
+		std::shared_ptr<const renderer::MapSettings> map_settings_ = std::make_shared<const renderer::MapSettings>();
+	};
+
+	template <typename Builder>
+	void PartitionedCatalogue::BuildAll(Builder&& builder) {
+		parallel::ParallelFor(regions_.size(), 1, [&](size_t begin, size_t end) {
+			for (RegionId region = begin; region < end; ++region) {
+				auto snapshot = std::make_unique<CatalogueSnapshot>();
+				snapshot->renderer.SetMapSettings(map_settings_);
+				builder(region, *snapshot);
+				snapshot->router.BuildGraphRoute();
+				regions_[region]->store.Publish(std::move(snapshot));
+			}
+			});
+	}
+
+	template <typename Updater>
+	uint64_t PartitionedCatalogue::Update(RegionId region, Updater&& updater) {
+		return regions_.at(region)->store.Update(std::forward<Updater>(updater));
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace transportcatalogue {
+
+	// Упорядоченный по убыванию значения индекс записей справочника (BusPtr или StopPtr).
+	// Равные значения упорядочены по имени. Вставка и удаление - O(log n),
+	// первые K записей и записи из диапазона значений выдаются без просмотра остальных.
+	template <typename Item>
+	class RankingIndex {
+	public:
+		using Ranked = std::pair<Item, double>;
+
+		void Clear() {
+			entries_.clear();
+		}
+
+		size_t GetSize() const {
+			return entries_.size();
+		}
+
+		// Удалять нужно с тем же значением, с которым запись вставлялась
+		void Insert(Item item, double value) {
+			entries_.insert(Entry{ item, Normalize(value) });
+		}
+
+		void Erase(Item item, double value) {
+			entries_.erase(Entry{ item, Normalize(value) });
+		}
+
+		std::vector<Ranked> GetTop(size_t count) const {
+			std::vector<Ranked> result;
+			for (auto itr = entries_.begin(); itr != entries_.end() && result.size() < count; ++itr) {
+				result.emplace_back(itr->item, itr->value);
+			}
+			return result;
+		}
+
+		// Записи со значением из [min, max] по убыванию значения, не больше count
+		std::vector<Ranked> GetRange(double min, double max, size_t count) const {
+			std::vector<Ranked> result;
+			for (auto itr = entries_.lower_bound(max); itr != entries_.end() && itr->value >= min && result.size() < count; ++itr) {
+				result.emplace_back(itr->item, itr->value);
+			}
+			return result;
+		}
+
+	private:
+		struct Entry {
+			Item item;
+			double value = 0.0;
+		};
+
+		struct Compare {
+			using is_transparent = void;
+
+			bool operator()(const Entry& lhs, const Entry& rhs) const {
+				if (lhs.value != rhs.value) {
+					return lhs.value > rhs.value;
+				}
+				if (lhs.item->name != rhs.item->name) {
+					return lhs.item->name < rhs.item->name;
+				}
+				return lhs.item < rhs.item;
+			}
+			bool operator()(const Entry& lhs, double rhs) const {
+				return lhs.value > rhs;
+			}
+			bool operator()(double lhs, const Entry& rhs) const {
+				return lhs > rhs.value;
+			}
+		};
+
+		// NaN (например, извилистость маршрута нулевой длины) нарушил бы порядок множества
+		static double Normalize(double value) {
+			return std::isnan(value) ? 0.0 : value;
+		}
+
+	private:
+		std::set<Entry, Compare> entries_;
+	};
+}
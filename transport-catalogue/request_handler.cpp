@@ -10,26 +10,8 @@ int RequestHandler::GetCountStatisticsRequest(void) const {
 	return statistics_request_.size();
 }
 
-const std::vector<BusPtr>* RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
-	const std::vector<BusPtr>* ptr_buses = nullptr;
-
-	const unordered_set<string_view>& buses_by_stop_string = db_.GetRouteForBusStop(stop_name);
-	if (buses_by_stop_string.empty()) {
-		return ptr_buses;
-	}
-
-	std::vector<BusPtr> buses_by_stop_set;
-	for (const auto str : buses_by_stop_string) {
-		buses_by_stop_set.push_back(db_.GetRouteInfo(str));
-	}
-	
-	try {
-		ptr_buses = new vector<BusPtr>(std::move(buses_by_stop_set));
-	}
-	catch (const std::exception&) {
-		
-	}
-	return ptr_buses;
+std::span<const BusPtr> RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
+	return db_.GetBusesByStop(stop_name);
 }
 
 const std::tuple<int, std::string, std::string>& RequestHandler::GetRequestByNumber(int id) const {
@@ -41,11 +23,11 @@ const std::tuple<int, std::string, std::string>& RequestHandler::GetRequestByNum
 }
 
 std::optional<BusStat> RequestHandler::GetBusStat(const std::string_view& bus_name) const {
-	BusStat busstat = db_.GetRouteStatistic(bus_name);
-	if (busstat.count_stopbus == 0) {
+	BusPtr bus = db_.GetRouteInfo(bus_name);
+	if (bus == nullptr || bus->busstop_info.empty()) {
 		return std::nullopt;
 	}
-	return busstat;
+	return db_.GetRouteStatistic(bus);
 }
 
 StopPtr RequestHandler::GetStopBusByName(const std::string_view& stop_name) const {
@@ -64,6 +46,48 @@ void RequestHandler::AddStopTo(int id, std::string stop_to) {
 	stop_destination_[id] = stop_to;
 }
 
+const json::Dict& RequestHandler::GetRequestParamsById(int id) const {
+	return request_params_.at(id);
+}
+
+void RequestHandler::AddRequestParams(int id, json::Dict params) {
+	request_params_[id] = std::move(params);
+}
+
+vector<StopGridIndex::StopDistance> RequestHandler::GetNearestStops(Coordinates point, size_t count) const {
+	return db_.GetNearestStops(point, count);
+}
+
+vector<StopPtr> RequestHandler::GetStopsInBox(Coordinates min, Coordinates max) const {
+	return db_.GetStopsInBox(min, max);
+}
+
+vector<NameSearchIndex::Match> RequestHandler::SearchNamesByPrefix(std::string_view prefix, size_t limit) const {
+	return db_.SearchNamesByPrefix(prefix, limit);
+}
+
+vector<NameSearchIndex::Match> RequestHandler::SearchNamesFuzzy(std::string_view query, size_t max_distance, size_t limit) const {
+	return db_.SearchNamesFuzzy(query, max_distance, limit);
+}
+
+void RequestHandler::SetInputDocument(const json::Document& doc) {
+	input_document_ = &doc;
+}
+
+void RequestHandler::ReportMemory(memory::MemoryReport& report) const {
+	db_.ReportMemory(report, "catalogue");
+	router_.ReportMemory(report, "router");
+	renderer_.ReportMemory(report, "renderer");
+	if (input_document_ != nullptr) {
+		json::ReportMemory(*input_document_, report, "json");
+	}
+	size_t bytes = memory::HeapBytes(statistics_request_);
+	for (const auto& [id, type, name] : statistics_request_) {
+		bytes += memory::HeapBytes(type) + memory::HeapBytes(name);
+	}
+	report.Add("handler", "requests", bytes, statistics_request_.size());
+}
+
 svg::Document RequestHandler::RenderMap() const {
 	svg::Document doc;
 
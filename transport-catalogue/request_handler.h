@@ -11,6 +11,7 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
 #include "map_renderer.h"
+#include "catalogue_snapshot.h"
 
 using namespace transportcatalogue;
 using namespace renderer;
@@ -23,17 +24,32 @@ public:
           router_(router),
           renderer_(renderer) {};
 
+    // Обслуживание запросов из закреплённой версии справочника; версия должна жить дольше обработчика
+    explicit RequestHandler(const CatalogueSnapshot& snapshot)
+        : RequestHandler(snapshot.catalogue, snapshot.router, snapshot.renderer) {};
+
     std::optional<BusStat> GetBusStat(const std::string_view& bus_name) const;
-    const std::vector<BusPtr>* GetBusesByStop(const std::string_view& stop_name) const;
+    std::span<const BusPtr> GetBusesByStop(const std::string_view& stop_name) const;
     StopPtr GetStopBusByName(const std::string_view& stop_name) const;
     svg::Document RenderMap() const;
 
     void AddStatisticsRequest(std::tuple<int, std::string, std::string>& stat_req);
     void AddStopTo(int, std::string);
+    void AddRequestParams(int, json::Dict);
     int GetCountStatisticsRequest(void) const;
     const std::tuple<int, std::string, std::string>& GetRequestByNumber(int id) const;
     const unordered_map<string_view, BusPtr>& GetBusesInfo() const;
     const std::string& GetStopToById(int) const;
+    const json::Dict& GetRequestParamsById(int) const;
+    vector<StopGridIndex::StopDistance> GetNearestStops(Coordinates point, size_t count) const;
+    vector<StopPtr> GetStopsInBox(Coordinates min, Coordinates max) const;
+    vector<NameSearchIndex::Match> SearchNamesByPrefix(std::string_view prefix, size_t limit) const;
+    vector<NameSearchIndex::Match> SearchNamesFuzzy(std::string_view query, size_t max_distance, size_t limit) const;
+
+    // Входной документ учитывается в отчёте о памяти; должен жить дольше обработчика
+    void SetInputDocument(const json::Document& doc);
+    // Память справочника, маршрутизатора, отрисовщика, входного документа и сохранённых запросов
+    void ReportMemory(memory::MemoryReport& report) const;
 
     const TransportCatalogue& GetTransportCatalogue() const {
         return db_;
@@ -49,4 +65,6 @@ private:
     const renderer::MapRenderer& renderer_;
     vector<std::tuple<int, std::string, std::string>> statistics_request_{};
     unordered_map<int, std::string> stop_destination_;
+    unordered_map<int, json::Dict> request_params_;
+    const json::Document* input_document_ = nullptr;
 };
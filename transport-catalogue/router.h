@@ -6,9 +6,14 @@
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <functional>
 #include <optional>
+#include <queue>
+#include <set>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -27,7 +32,31 @@ namespace graph {
             std::vector<EdgeId> edges;
         };
 
+        // Маршрут из одной из вершин sources в одну из вершин targets; к весу пути добавляются
+        // вес входа в source и выхода из target. weight - полный вес с добавками
+        struct MultiRouteInfo {
+            Weight weight;
+            size_t source;
+            size_t target;
+            RouteInfo route;
+        };
+
         std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        std::optional<MultiRouteInfo> BuildRoute(const std::vector<std::pair<VertexId, Weight>>& sources,
+            const std::vector<std::pair<VertexId, Weight>>& targets) const;
+        // До count маршрутов без циклов по возрастанию веса (алгоритм Йена). Ответвления ищутся A*
+        // с точной оценкой остатка пути из таблицы кратчайших путей, поэтому каждый поиск
+        // просматривает лишь вершины рядом с ответвлением, а не весь граф
+        std::vector<RouteInfo> BuildRoutes(VertexId from, VertexId to, size_t count) const;
+        void ReportMemory(memory::MemoryReport& report, const std::string& prefix) const {
+            size_t bytes = memory::HeapBytes(routes_internal_data_);
+            size_t count = 0;
+            for (const auto& row : routes_internal_data_) {
+                bytes += memory::HeapBytes(row);
+                count += row.size();
+            }
+            report.Add(prefix, "routes_internal_data", bytes, count);
+        }
 
     private:
         struct RouteInternalData {
@@ -75,6 +104,19 @@ namespace graph {
             }
         }
 
+        // Рабочие массивы поиска ответвлений, общие для всех итераций BuildRoutes.
+        // После поиска сбрасываются только посещённые вершины
+        struct SearchState {
+            std::vector<std::optional<Weight>> distance;
+            std::vector<std::optional<EdgeId>> prev_edge;
+            std::vector<bool> closed;
+            std::vector<bool> removed_vertex;
+            std::vector<VertexId> touched;
+        };
+
+        std::optional<RouteInfo> BuildSpurRoute(VertexId from, VertexId to,
+            const std::unordered_set<EdgeId>& removed_edges, SearchState& state) const;
+
         static constexpr Weight ZERO_WEIGHT{};
         const Graph& graph_;
         RoutesInternalData routes_internal_data_;
@@ -114,4 +156,160 @@ namespace graph {
         return RouteInfo{ weight, std::move(edges) };
     }
 
+    template <typename Weight>
+    std::optional<typename Router<Weight>::MultiRouteInfo> Router<Weight>::BuildRoute(
+        const std::vector<std::pair<VertexId, Weight>>& sources,
+        const std::vector<std::pair<VertexId, Weight>>& targets) const {
+        // Веса кратчайших путей между всеми парами уже посчитаны: выбор лучшей пары - просмотр таблицы,
+        // а путь восстанавливается только для неё
+        std::optional<MultiRouteInfo> result;
+        for (size_t source = 0; source < sources.size(); ++source) {
+            const auto& row = routes_internal_data_.at(sources[source].first);
+            for (size_t target = 0; target < targets.size(); ++target) {
+                const auto& route_internal_data = row.at(targets[target].first);
+                if (!route_internal_data) {
+                    continue;
+                }
+                const Weight weight = sources[source].second + route_internal_data->weight + targets[target].second;
+                if (!result || weight < result->weight) {
+                    result = MultiRouteInfo{ weight, source, target, {} };
+                }
+            }
+        }
+        if (result) {
+            result->route = *BuildRoute(sources[result->source].first, targets[result->target].first);
+        }
+        return result;
+    }
+
+    template <typename Weight>
+    std::vector<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoutes(VertexId from, VertexId to,
+        size_t count) const {
+        std::vector<RouteInfo> routes;
+        if (count == 0) {
+            return routes;
+        }
+        std::optional<RouteInfo> shortest = BuildRoute(from, to);
+        if (!shortest) {
+            return routes;
+        }
+        routes.push_back(std::move(*shortest));
+
+        const size_t vertex_count = graph_.GetVertexCount();
+        SearchState state{ std::vector<std::optional<Weight>>(vertex_count), std::vector<std::optional<EdgeId>>(vertex_count),
+            std::vector<bool>(vertex_count), std::vector<bool>(vertex_count), {} };
+        // Кандидаты по возрастанию веса; пути, которые уже встречались, повторно не добавляются
+        std::set<std::pair<Weight, std::vector<EdgeId>>> candidates;
+        std::set<std::vector<EdgeId>> known_paths{ routes.front().edges };
+        std::unordered_set<EdgeId> removed_edges;
+        std::vector<VertexId> root_vertexes;
+
+        while (routes.size() < count) {
+            const std::vector<EdgeId> prev_edges = routes.back().edges;
+            Weight root_weight = ZERO_WEIGHT;
+            VertexId spur = from;
+            for (size_t i = 0; i < prev_edges.size(); ++i) {
+                // Ребро ответвления не должно повторять найденные маршруты с тем же корнем
+                removed_edges.clear();
+                for (const RouteInfo& route : routes) {
+                    if (route.edges.size() > i && std::equal(prev_edges.begin(), prev_edges.begin() + i, route.edges.begin())) {
+                        removed_edges.insert(route.edges[i]);
+                    }
+                }
+                if (std::optional<RouteInfo> spur_route = BuildSpurRoute(spur, to, removed_edges, state)) {
+                    std::vector<EdgeId> edges(prev_edges.begin(), prev_edges.begin() + i);
+                    edges.insert(edges.end(), spur_route->edges.begin(), spur_route->edges.end());
+                    if (known_paths.insert(edges).second) {
+                        candidates.emplace(root_weight + spur_route->weight, std::move(edges));
+                    }
+                }
+                // Вершины корня исключаются из следующих ответвлений, так маршруты остаются без циклов
+                state.removed_vertex[spur] = true;
+                root_vertexes.push_back(spur);
+                const auto& edge = graph_.GetEdge(prev_edges[i]);
+                root_weight += edge.weight;
+                spur = edge.to;
+            }
+            for (VertexId vertex : root_vertexes) {
+                state.removed_vertex[vertex] = false;
+            }
+            root_vertexes.clear();
+
+            if (candidates.empty()) {
+                break;
+            }
+            routes.push_back(RouteInfo{ candidates.begin()->first, candidates.begin()->second });
+            candidates.erase(candidates.begin());
+        }
+        return routes;
+    }
+
+    template <typename Weight>
+    std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildSpurRoute(VertexId from, VertexId to,
+        const std::unordered_set<EdgeId>& removed_edges, SearchState& state) const {
+        // Вес кратчайшего пути до to без ограничений - допустимая и монотонная оценка для A*
+        auto estimate = [&](VertexId vertex) -> const std::optional<RouteInternalData>& {
+            return routes_internal_data_[vertex][to];
+        };
+        std::optional<RouteInfo> result;
+        if (state.removed_vertex[from] || !estimate(from)) {
+            return result;
+        }
+
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        state.distance[from] = ZERO_WEIGHT;
+        state.touched.push_back(from);
+        queue.emplace(estimate(from)->weight, from);
+
+        while (!queue.empty()) {
+            const VertexId vertex = queue.top().second;
+            queue.pop();
+            if (state.closed[vertex]) {
+                continue;
+            }
+            state.closed[vertex] = true;
+            if (vertex == to) {
+                break;
+            }
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                if (state.removed_vertex[edge.to] || state.closed[edge.to] || removed_edges.count(edge_id) > 0) {
+                    continue;
+                }
+                const auto& rest = estimate(edge.to);
+                if (!rest) {
+                    continue;
+                }
+                const Weight weight = *state.distance[vertex] + edge.weight;
+                auto& distance = state.distance[edge.to];
+                if (!distance || weight < *distance) {
+                    if (!distance) {
+                        state.touched.push_back(edge.to);
+                    }
+                    distance = weight;
+                    state.prev_edge[edge.to] = edge_id;
+                    queue.emplace(weight + rest->weight, edge.to);
+                }
+            }
+        }
+
+        if (state.closed[to]) {
+            std::vector<EdgeId> edges;
+            for (VertexId vertex = to; vertex != from; vertex = graph_.GetEdge(*state.prev_edge[vertex]).from) {
+                edges.push_back(*state.prev_edge[vertex]);
+            }
+            std::reverse(edges.begin(), edges.end());
+            result = RouteInfo{ *state.distance[to], std::move(edges) };
+        }
+
+        for (const VertexId vertex : state.touched) {
+            state.distance[vertex].reset();
+            state.prev_edge[vertex].reset();
+            state.closed[vertex] = false;
+        }
+        state.touched.clear();
+        return result;
+    }
+
 }  // namespace graph
\ No newline at end of file
@@ -32,18 +32,16 @@ void ParseAndPrintStat(const TransportCatalogue& tansport_catalogue, std::string
             return;
         }
 
-        vector<string_view> statistic(tansport_catalogue.GetRouteForBusStop(busroute).begin(), tansport_catalogue.GetRouteForBusStop(busroute).end());
+        std::span<const BusPtr> statistic = tansport_catalogue.GetBusesByStop(busroute);
         
         if (statistic.empty()) {
             output << "Stop "s << busroute << ": no buses" << "\n";
             return;
         }
 
-        sort(statistic.begin(), statistic.end());
-        
         output << "Stop "s << busroute << ": buses";
-        for (auto it = statistic.begin(); it != statistic.end(); ++it) {
-            output << " " << *it;
+        for (BusPtr bus : statistic) {
+            output << " " << bus->name;
         }
         output << "\n";
     }
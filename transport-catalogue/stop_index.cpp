@@ -0,0 +1,239 @@
+#define _USE_MATH_DEFINES
+#include "stop_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace transportcatalogue {
+
+	namespace {
+		// Длина дуги в один градус на сфере радиусом geo::ComputeDistance
+		const double METERS_PER_DEGREE = EARTH_RADIUS * M_PI / 180.0;
+		// Запас на неточность плоской оценки размера ячейки
+		const double CELL_SIZE_SAFETY = 0.99;
+		const double MIN_SPAN = 1e-6;
+
+		bool CompareByDistance(const StopGridIndex::StopDistance& lhs, const StopGridIndex::StopDistance& rhs) {
+			if (lhs.second != rhs.second) {
+				return lhs.second < rhs.second;
+			}
+			return lhs.first->name < rhs.first->name;
+		}
+	}
+
+	void StopGridIndex::Build(const std::vector<StopPtr>& stops, const UnitVectors& vectors) {
+		Clear();
+		if (stops.empty()) {
+			return;
+		}
+		vectors_ = &vectors;
+
+		const auto [bottom_it, top_it] = std::minmax_element(stops.begin(), stops.end(),
+			[](StopPtr lhs, StopPtr rhs) { return lhs->coordinates.lat < rhs->coordinates.lat; });
+		const auto [left_it, right_it] = std::minmax_element(stops.begin(), stops.end(),
+			[](StopPtr lhs, StopPtr rhs) { return lhs->coordinates.lng < rhs->coordinates.lng; });
+
+		min_lat_ = (*bottom_it)->coordinates.lat;
+		min_lng_ = (*left_it)->coordinates.lng;
+		const double lat_span = std::max((*top_it)->coordinates.lat - min_lat_, MIN_SPAN);
+		const double lng_span = std::max((*right_it)->coordinates.lng - min_lng_, MIN_SPAN);
+
+		const double max_abs_lat = std::max(std::abs(min_lat_), std::abs(min_lat_ + lat_span));
+		const double mid_lat = min_lat_ + lat_span / 2;
+		const double height = lat_span * METERS_PER_DEGREE;
+		const double width = lng_span * METERS_PER_DEGREE * std::cos(mid_lat * M_PI / 180.0);
+
+		const double target_cells = std::max<double>(1.0, stops.size() / 2.0);
+		const double cell_size = std::sqrt(height * width / target_cells);
+
+		rows_ = std::clamp<size_t>(static_cast<size_t>(std::ceil(height / cell_size)), 1, stops.size());
+		cols_ = std::clamp<size_t>(static_cast<size_t>(std::ceil(width / cell_size)), 1, stops.size());
+		lat_step_ = lat_span / rows_;
+		lng_step_ = lng_span / cols_;
+
+		const double lng_meters = std::cos(std::min(max_abs_lat, 89.0) * M_PI / 180.0) * METERS_PER_DEGREE;
+		min_cell_size_ = std::min(lat_step_ * METERS_PER_DEGREE, lng_step_ * lng_meters) * CELL_SIZE_SAFETY;
+
+		cells_.resize(rows_ * cols_);
+		for (StopPtr stop : stops) {
+			Insert(stop);
+		}
+	}
+
+	void StopGridIndex::Clear() {
+		cells_.clear();
+		rows_ = 0;
+		cols_ = 0;
+	}
+
+	bool StopGridIndex::IsBuilt() const {
+		return !cells_.empty();
+	}
+
+	void StopGridIndex::Insert(StopPtr stop) {
+		if (!IsBuilt()) {
+			return;
+		}
+		cells_[GetCellIndex(GetCell(stop->coordinates))].push_back(stop);
+	}
+
+	void StopGridIndex::Erase(StopPtr stop) {
+		if (!IsBuilt()) {
+			return;
+		}
+		std::vector<StopPtr>& cell = cells_[GetCellIndex(GetCell(stop->coordinates))];
+		auto itr = std::find(cell.begin(), cell.end(), stop);
+		if (itr != cell.end()) {
+			*itr = cell.back();
+			cell.pop_back();
+		}
+	}
+
+	std::vector<StopGridIndex::StopDistance> StopGridIndex::FindNearest(Coordinates point, size_t count) const {
+		std::vector<StopDistance> result;
+		if (!IsBuilt() || count == 0) {
+			return result;
+		}
+
+		std::vector<size_t> ids;
+		std::vector<double> distances;
+		const CellId center = GetCell(point);
+		const size_t max_ring = std::max(rows_, cols_);
+
+		for (size_t ring = 0; ring <= max_ring; ++ring) {
+			const size_t row_begin = center.row >= ring ? center.row - ring : 0;
+			const size_t row_end = std::min(center.row + ring, rows_ - 1);
+			const size_t col_begin = center.col >= ring ? center.col - ring : 0;
+			const size_t col_end = std::min(center.col + ring, cols_ - 1);
+
+			auto scan_cell = [&](size_t row, size_t col) {
+				const std::vector<StopPtr>& cell = cells_[GetCellIndex({ row, col })];
+				ComputeCellDistances(point, cell, ids, distances);
+				for (size_t i = 0; i < cell.size(); ++i) {
+					result.emplace_back(cell[i], distances[i]);
+				}
+			};
+
+			for (size_t row = row_begin; row <= row_end; ++row) {
+				if (row + ring == center.row || row == center.row + ring) {
+					for (size_t col = col_begin; col <= col_end; ++col) {
+						scan_cell(row, col);
+					}
+					continue;
+				}
+				// Во внутренних строках кольца лежат только две крайние ячейки
+				if (center.col >= ring) {
+					scan_cell(row, center.col - ring);
+				}
+				if (center.col + ring < cols_) {
+					scan_cell(row, center.col + ring);
+				}
+			}
+
+			if (result.size() >= count) {
+				std::nth_element(result.begin(), result.begin() + (count - 1), result.end(), CompareByDistance);
+				if (result[count - 1].second <= GetRingLowerBound(ring + 1)) {
+					break;
+				}
+			}
+		}
+
+		std::sort(result.begin(), result.end(), CompareByDistance);
+		if (result.size() > count) {
+			result.resize(count);
+		}
+		return result;
+	}
+
+	std::vector<StopPtr> StopGridIndex::FindInBox(Coordinates min, Coordinates max) const {
+		std::vector<StopPtr> result;
+		if (!IsBuilt() || min.lat > max.lat || min.lng > max.lng) {
+			return result;
+		}
+
+		const CellId first = GetCell(min);
+		const CellId last = GetCell(max);
+		for (size_t row = first.row; row <= last.row; ++row) {
+			for (size_t col = first.col; col <= last.col; ++col) {
+				for (StopPtr stop : cells_[GetCellIndex({ row, col })]) {
+					const Coordinates& c = stop->coordinates;
+					if (c.lat >= min.lat && c.lat <= max.lat && c.lng >= min.lng && c.lng <= max.lng) {
+						result.push_back(stop);
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	std::vector<StopGridIndex::StopDistance> StopGridIndex::FindInRadius(Coordinates point, double radius) const {
+		std::vector<StopDistance> result;
+		if (!IsBuilt() || radius < 0) {
+			return result;
+		}
+
+		const double lat_delta = radius / METERS_PER_DEGREE;
+		const double lat_cos = std::cos(std::min(std::abs(point.lat) + lat_delta, 89.0) * M_PI / 180.0);
+		const double lng_delta = radius / (METERS_PER_DEGREE * lat_cos);
+
+		std::vector<size_t> ids;
+		std::vector<double> distances;
+		const CellId first = GetCell({ point.lat - lat_delta, point.lng - lng_delta });
+		const CellId last = GetCell({ point.lat + lat_delta, point.lng + lng_delta });
+		for (size_t row = first.row; row <= last.row; ++row) {
+			for (size_t col = first.col; col <= last.col; ++col) {
+				const std::vector<StopPtr>& cell = cells_[GetCellIndex({ row, col })];
+				ComputeCellDistances(point, cell, ids, distances);
+				for (size_t i = 0; i < cell.size(); ++i) {
+					if (distances[i] <= radius) {
+						result.emplace_back(cell[i], distances[i]);
+					}
+				}
+			}
+		}
+		std::sort(result.begin(), result.end(), CompareByDistance);
+		return result;
+	}
+
+	size_t StopGridIndex::GetCellCount() const {
+		return cells_.size();
+	}
+
+	void StopGridIndex::ReportMemory(memory::MemoryReport& report, const std::string& prefix) const {
+		size_t bytes = memory::HeapBytes(cells_);
+		size_t stops = 0;
+		for (const std::vector<StopPtr>& cell : cells_) {
+			bytes += memory::HeapBytes(cell);
+			stops += cell.size();
+		}
+		report.Add(prefix, "cells", bytes, cells_.size());
+		report.Add(prefix, "stops", 0, stops);
+	}
+
+	StopGridIndex::CellId StopGridIndex::GetCell(Coordinates point) const {
+		const double row = std::floor((point.lat - min_lat_) / lat_step_);
+		const double col = std::floor((point.lng - min_lng_) / lng_step_);
+		return {
+			static_cast<size_t>(std::clamp(row, 0.0, static_cast<double>(rows_ - 1))),
+			static_cast<size_t>(std::clamp(col, 0.0, static_cast<double>(cols_ - 1)))
+		};
+	}
+
+	size_t StopGridIndex::GetCellIndex(CellId cell) const {
+		return cell.row * cols_ + cell.col;
+	}
+
+	double StopGridIndex::GetRingLowerBound(size_t ring) const {
+		return ring == 0 ? 0.0 : (ring - 1) * min_cell_size_;
+	}
+
+	void StopGridIndex::ComputeCellDistances(Coordinates point, const std::vector<StopPtr>& cell,
+		std::vector<size_t>& ids, std::vector<double>& distances) const {
+		ids.clear();
+		for (StopPtr stop : cell) {
+			ids.push_back(stop->id);
+		}
+		distances.resize(ids.size());
+		ComputeDistancesFrom(point, *vectors_, ids.data(), ids.size(), distances.data());
+	}
+}
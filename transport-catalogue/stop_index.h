@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "domain.h"
+
+namespace transportcatalogue {
+
+	// Равномерная сетка по координатам остановок.
+	// Размер ячейки подбирается при построении так, чтобы в ячейке в среднем было около двух остановок,
+	// поэтому поиск ближайших и выборка по прямоугольнику просматривают лишь ячейки рядом с запросом.
+	// Рассчитана на масштаб города/агломерации: оценка расстояния до кольца ячеек идёт в плоском приближении.
+	class StopGridIndex {
+	public:
+		using StopDistance = std::pair<StopPtr, double>;
+
+		// vectors - единичные векторы остановок по StopInfo::id, должны жить дольше индекса
+		void Build(const std::vector<StopPtr>& stops, const UnitVectors& vectors);
+		void Clear();
+		bool IsBuilt() const;
+
+		// Точки вне исходных границ попадают в крайние ячейки, корректность запросов при этом сохраняется
+		void Insert(StopPtr stop);
+		void Erase(StopPtr stop);
+
+		// count ближайших остановок по расстоянию на сфере, по возрастанию расстояния
+		std::vector<StopDistance> FindNearest(Coordinates point, size_t count) const;
+		// Остановки внутри прямоугольника [min, max] по широте и долготе
+		std::vector<StopPtr> FindInBox(Coordinates min, Coordinates max) const;
+		// Остановки не дальше radius метров от point, по возрастанию расстояния
+		std::vector<StopDistance> FindInRadius(Coordinates point, double radius) const;
+
+		size_t GetCellCount() const;
+		void ReportMemory(memory::MemoryReport& report, const std::string& prefix) const;
+
+	private:
+		struct CellId {
+			size_t row = 0;
+			size_t col = 0;
+		};
+
+		CellId GetCell(Coordinates point) const;
+		size_t GetCellIndex(CellId cell) const;
+		// Гарантированная нижняя граница расстояния до остановок в кольце ring вокруг ячейки запроса
+		double GetRingLowerBound(size_t ring) const;
+		// Расстояния от point до всех остановок ячейки одним пакетом; ids и distances - рабочие буферы вызывающего
+		void ComputeCellDistances(Coordinates point, const std::vector<StopPtr>& cell,
+			std::vector<size_t>& ids, std::vector<double>& distances) const;
+
+	private:
+		double min_lat_ = 0.0;
+		double min_lng_ = 0.0;
+		double lat_step_ = 1.0;
+		double lng_step_ = 1.0;
+		double min_cell_size_ = 0.0;
+		size_t rows_ = 0;
+		size_t cols_ = 0;
+		std::vector<std::vector<StopPtr>> cells_;
+		const UnitVectors* vectors_ = nullptr;
+	};
+}
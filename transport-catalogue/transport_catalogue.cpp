@@ -1,35 +1,140 @@
 #include "transport_catalogue.h"
+#include "parallel.h"
 
 namespace transportcatalogue {
 
-    void TransportCatalogue::AddBusStop(const string& name, Coordinates coordinates) {
+    namespace {
+        // Замеряет время операции изменения справочника и накапливает его в статистике
+        class UpdateTimer {
+        public:
+            explicit UpdateTimer(TransportCatalogue::UpdateStatistic& statistic)
+                : statistic_(statistic)
+                , start_(std::chrono::steady_clock::now()) {
+            }
+
+            ~UpdateTimer() {
+                const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+                ++statistic_.count;
+                statistic_.total += duration;
+                statistic_.last = duration;
+            }
+
+        private:
+            TransportCatalogue::UpdateStatistic& statistic_;
+            std::chrono::steady_clock::time_point start_;
+        };
+
+        bool CompareBusByName(BusPtr lhs, BusPtr rhs) {
+            return lhs->name < rhs->name;
+        }
+
+        // Вес автобуса в индексе имён; unique_stops - рабочий буфер
+        size_t CountUniqueStops(BusPtr bus, vector<StopPtr>& unique_stops) {
+            unique_stops.assign(bus->busstop_info.begin(), bus->busstop_info.end());
+            std::sort(unique_stops.begin(), unique_stops.end());
+            return std::unique(unique_stops.begin(), unique_stops.end()) - unique_stops.begin();
+        }
+    }
+
+    TransportCatalogue::TransportCatalogue(const TransportCatalogue& other)
+        : name_buffers_(other.name_buffers_) {
+        // Удалённые записи остаются в deque исходного справочника, в копию они не переносятся.
+        // Имена из общих буферов не копируются, остальные копируются в names_ копии
+        for (const StopInfo& stop : other.busstop_info_) {
+            if (other.GetBusStopInfo(stop.name) == &stop) {
+                AddBusStop(stop.name, stop.coordinates);
+            }
+        }
+
+        for (const auto& [stops, distance] : other.busstop_distance_info_) {
+            SetBusStopDistance(stops.first->name, stops.second->name, distance);
+        }
+
+        vector<string_view> stops_name;
+        for (const BusInfo& bus : other.busroute_info_) {
+            if (other.GetRouteInfo(bus.name) != &bus) {
+                continue;
+            }
+            stops_name.clear();
+            for (StopPtr stop : bus.busstop_info) {
+                stops_name.push_back(stop->name);
+            }
+            AddBusRoute(bus.name, stops_name, bus.type);
+            // Статистика источника уже согласована с данными, копируем её без пересчёта
+            busroute_info_.back().statistic = bus.statistic;
+        }
+        statistics_ready_ = other.statistics_ready_;
+        statistics_build_time_ = other.statistics_build_time_;
+        if (statistics_ready_) {
+            BuildBusRankings();
+        }
+
+        if (other.stop_index_.IsBuilt()) {
+            BuildIndexes();
+        }
+    }
+
+    void TransportCatalogue::AdoptNameBuffer(std::shared_ptr<const string> buffer) {
+        if (buffer != nullptr) {
+            name_buffers_.push_back(move(buffer));
+        }
+    }
+
+    string_view TransportCatalogue::StoreName(string_view name) {
+        for (const auto& buffer : name_buffers_) {
+            const char* begin = buffer->data();
+            if (name.data() >= begin && name.data() + name.size() <= begin + buffer->size()) {
+                return name;
+            }
+        }
+        return names_.emplace_back(name);
+    }
+
+    void TransportCatalogue::AddBusStop(string_view name, Coordinates coordinates) {
 
         if (name.empty()) {
             return;
         }
 
-        StopInfo sbusstopinfo{ name , coordinates };
+        StopInfo sbusstopinfo{ StoreName(name), coordinates, stop_vectors_.Add(coordinates) };
 
         busstop_info_.push_back(move(sbusstopinfo));
         ptr_busstop_info_[busstop_info_.back().name] = &busstop_info_.back();
+        stop_index_.Insert(&busstop_info_.back());
+        RankStop(&busstop_info_.back());
+        name_index_.Insert({ busstop_info_.back().name, NameSearchIndex::Kind::STOP, 0 });
     }
 
     void TransportCatalogue::SetBusStopDistance(std::string_view busstop, std::string_view busstop_next, int distance) {
         if (busstop.empty() || busstop_next.empty() || distance == 0) {
             return;
         }
-        std::string_view busstop_name = ptr_busstop_info_[busstop]->name;
-        std::string_view distance_name = ptr_busstop_info_[busstop_next]->name;
-        std::pair<string_view, string_view> p_tmp{ move(busstop_name), move(distance_name) };
-        busstop_distance_info_[move(p_tmp)] = distance;
+        StopPtr from = GetBusStopInfo(busstop);
+        StopPtr to = GetBusStopInfo(busstop_next);
+        if (from == nullptr || to == nullptr) {
+            return;
+        }
+        SetBusStopDistance(from, to, distance);
+        // Отрезок from - to в любую сторону проходит через from
+        RefreshStatisticsByStop(from);
     }
 
-    void TransportCatalogue::AddBusRoute(const string& name, const vector<string_view>& busroute, bool type) {
+    void TransportCatalogue::SetBusStopDistance(StopPtr from, StopPtr to, int distance) {
+        auto [itr, inserted] = busstop_distance_info_.insert_or_assign({ from, to }, distance);
+        if (inserted) {
+            busstop_distance_links_[from].push_back(to);
+            if (from != to) {
+                busstop_distance_links_[to].push_back(from);
+            }
+        }
+    }
+
+    void TransportCatalogue::AddBusRoute(string_view name, const vector<string_view>& busroute, bool type) {
 
         if (name.empty() || busroute.empty()) {
             return;
         }
-        BusInfo sbusrouteinfo{ name, {} , type };
+        BusInfo sbusrouteinfo{ StoreName(name), {}, type, {} };
 
         for (auto itr = busroute.begin(); itr != busroute.end(); ++itr) {
             sbusrouteinfo.busstop_info.push_back(ptr_busstop_info_[*itr]);
@@ -37,9 +142,288 @@ namespace transportcatalogue {
 
         busroute_info_.push_back(move(sbusrouteinfo));
         ptr_busroute_info_[busroute_info_.back().name] = &busroute_info_.back();
+        BusPtr bus = &busroute_info_.back();
+        LinkBusToStops(bus);
+        vector<StopPtr> unique_stops;
+        name_index_.Insert({ bus->name, NameSearchIndex::Kind::BUS, CountUniqueStops(bus, unique_stops) });
+        RefreshStatistics(bus);
+    }
 
-        for (auto itr = busroute.begin(); itr != busroute.end(); ++itr) {
-            ptr_busstop_route_info_[ptr_busstop_info_[*itr]->name].insert(busroute_info_.back().name);
+    void TransportCatalogue::AddBatch(const CatalogueBatch& batch) {
+        // Кусок меньше этого не окупает запуск потока
+        constexpr size_t MIN_CHUNK = 4096;
+
+        const size_t stop_count = ptr_busstop_info_.size() + batch.stops.size();
+        ptr_busstop_info_.reserve(stop_count);
+        ptr_busstop_route_info_.reserve(stop_count);
+        busstop_distance_links_.reserve(stop_count);
+        busstop_distance_info_.reserve(busstop_distance_info_.size() + batch.distances.size());
+        ptr_busroute_info_.reserve(ptr_busroute_info_.size() + batch.buses.size());
+
+        // Остановки вставляются последовательно, единичные векторы считаются параллельно
+        const size_t first_stop = busstop_info_.size();
+        for (const StopRecord& record : batch.stops) {
+            if (record.name.empty()) {
+                continue;
+            }
+            busstop_info_.push_back({ StoreName(record.name), record.coordinates, stop_vectors_.GetSize() + busstop_info_.size() - first_stop });
+            ptr_busstop_info_[busstop_info_.back().name] = &busstop_info_.back();
+        }
+        const size_t added_stops = busstop_info_.size() - first_stop;
+        stop_vectors_.Resize(stop_vectors_.GetSize() + added_stops);
+        parallel::ParallelFor(added_stops, MIN_CHUNK, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const StopInfo& stop = busstop_info_[first_stop + i];
+                stop_vectors_.Set(stop.id, stop.coordinates);
+            }
+            });
+        for (size_t i = first_stop; i < busstop_info_.size(); ++i) {
+            stop_index_.Insert(&busstop_info_[i]);
+        }
+
+        // Разрешение имён - только чтение индекса остановок, его можно делить между потоками
+        vector<pair<StopPtr, StopPtr>> distance_stops(batch.distances.size());
+        parallel::ParallelFor(batch.distances.size(), MIN_CHUNK, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                distance_stops[i] = { GetBusStopInfo(batch.distances[i].from), GetBusStopInfo(batch.distances[i].to) };
+            }
+            });
+        for (size_t i = 0; i < distance_stops.size(); ++i) {
+            const auto [from, to] = distance_stops[i];
+            if (from != nullptr && to != nullptr && batch.distances[i].distance != 0) {
+                SetBusStopDistance(from, to, batch.distances[i].distance);
+            }
+        }
+
+        vector<vector<StopPtr>> bus_stops(batch.buses.size());
+        parallel::ParallelFor(batch.buses.size(), MIN_CHUNK / 16, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const BusRecord& record = batch.buses[i];
+                vector<StopPtr>& stops = bus_stops[i];
+                stops.reserve(record.is_roundtrip ? record.stops.size() : 2 * record.stops.size());
+                for (string_view name : record.stops) {
+                    StopPtr stop = GetBusStopInfo(name);
+                    if (stop == nullptr) {
+                        stops.clear();
+                        break;
+                    }
+                    stops.push_back(stop);
+                }
+                if (!record.is_roundtrip && !stops.empty()) {
+                    stops.insert(stops.end(), next(stops.rbegin()), stops.rend());
+                }
+            }
+            });
+
+        for (size_t i = 0; i < batch.buses.size(); ++i) {
+            const BusRecord& record = batch.buses[i];
+            if (record.name.empty() || bus_stops[i].empty()) {
+                continue;
+            }
+            busroute_info_.push_back({ StoreName(record.name), move(bus_stops[i]), record.is_roundtrip, {} });
+            BusPtr bus = &busroute_info_.back();
+            ptr_busroute_info_[bus->name] = bus;
+            for (StopPtr stop : bus->busstop_info) {
+                ptr_busstop_route_info_[stop->name].push_back(bus);
+            }
+        }
+
+        // Списки автобусов по остановкам дописывались без порядка: сортируем и убираем повторы за один проход
+        vector<vector<BusPtr>*> stop_buses;
+        stop_buses.reserve(ptr_busstop_route_info_.size());
+        for (auto& [name, buses] : ptr_busstop_route_info_) {
+            stop_buses.push_back(&buses);
+        }
+        parallel::ParallelFor(stop_buses.size(), MIN_CHUNK, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                vector<BusPtr>& buses = *stop_buses[i];
+                std::sort(buses.begin(), buses.end(), CompareBusByName);
+                buses.erase(std::unique(buses.begin(), buses.end()), buses.end());
+            }
+            });
+
+        // Пакет меняет много имён и весов сразу: индекс имён дешевле пересобрать целиком
+        if (name_index_.IsBuilt()) {
+            BuildNameIndex();
+        }
+        if (stop_ranking_built_) {
+            BuildStopRanking();
+        }
+        if (statistics_ready_) {
+            PrecomputeStatistics();
+        }
+    }
+
+    void TransportCatalogue::LinkBusToStops(BusPtr bus) {
+        for (StopPtr stop : bus->busstop_info) {
+            vector<BusPtr>& buses = ptr_busstop_route_info_[stop->name];
+            auto itr = std::lower_bound(buses.begin(), buses.end(), bus, CompareBusByName);
+            if (itr == buses.end() || *itr != bus) {
+                UnrankStop(stop);
+                buses.insert(itr, bus);
+                RankStop(stop);
+                name_index_.SetWeight(stop->name, NameSearchIndex::Kind::STOP, buses.size());
+            }
+        }
+    }
+
+    void TransportCatalogue::UnlinkBusFromStops(BusPtr bus) {
+        for (StopPtr stop : bus->busstop_info) {
+            auto stop_itr = ptr_busstop_route_info_.find(stop->name);
+            if (stop_itr == ptr_busstop_route_info_.end()) {
+                continue;
+            }
+            vector<BusPtr>& buses = stop_itr->second;
+            auto itr = std::lower_bound(buses.begin(), buses.end(), bus, CompareBusByName);
+            if (itr != buses.end() && *itr == bus) {
+                UnrankStop(stop);
+                buses.erase(itr);
+                RankStop(stop);
+                name_index_.SetWeight(stop->name, NameSearchIndex::Kind::STOP, buses.size());
+            }
+        }
+    }
+
+    BusInfo& TransportCatalogue::GetMutableBus(BusPtr bus) {
+        // Все записи принадлежат busroute_info_, константность BusPtr - только для внешних пользователей
+        return const_cast<BusInfo&>(*bus);
+    }
+
+    StopInfo& TransportCatalogue::GetMutableStop(StopPtr stop) {
+        return busstop_info_[stop->id];
+    }
+
+    bool TransportCatalogue::RemoveBus(string_view name) {
+        UpdateTimer timer(update_statistic_[static_cast<size_t>(UpdateOperation::REMOVE_BUS)]);
+        BusPtr bus = GetRouteInfo(name);
+        if (bus == nullptr) {
+            return false;
+        }
+        UnlinkBusFromStops(bus);
+        if (statistics_ready_) {
+            UnrankBus(bus);
+        }
+        name_index_.Erase(bus->name, NameSearchIndex::Kind::BUS);
+        ptr_busroute_info_.erase(bus->name);
+        GetMutableBus(bus).busstop_info.clear();
+        return true;
+    }
+
+    bool TransportCatalogue::ReplaceBus(string_view name, const vector<string_view>& busroute, bool type) {
+        UpdateTimer timer(update_statistic_[static_cast<size_t>(UpdateOperation::REPLACE_BUS)]);
+        BusPtr bus = GetRouteInfo(name);
+        if (bus == nullptr || busroute.empty()) {
+            return false;
+        }
+
+        vector<StopPtr> stops;
+        stops.reserve(busroute.size());
+        for (string_view stop_name : busroute) {
+            StopPtr stop = GetBusStopInfo(stop_name);
+            if (stop == nullptr) {
+                return false;
+            }
+            stops.push_back(stop);
+        }
+
+        // Запись автобуса сохраняется на месте, поэтому BusPtr у пользователей остаются действительными
+        UnlinkBusFromStops(bus);
+        BusInfo& mutable_bus = GetMutableBus(bus);
+        mutable_bus.busstop_info = move(stops);
+        mutable_bus.type = type;
+        LinkBusToStops(bus);
+        RefreshStatistics(bus);
+        name_index_.SetWeight(bus->name, NameSearchIndex::Kind::BUS, CountUniqueStops(bus, stops));
+        return true;
+    }
+
+    bool TransportCatalogue::MoveStop(string_view name, Coordinates coordinates) {
+        UpdateTimer timer(update_statistic_[static_cast<size_t>(UpdateOperation::MOVE_STOP)]);
+        StopPtr stop = GetBusStopInfo(name);
+        if (stop == nullptr) {
+            return false;
+        }
+        stop_index_.Erase(stop);
+        GetMutableStop(stop).coordinates = coordinates;
+        stop_vectors_.Set(stop->id, coordinates);
+        stop_index_.Insert(stop);
+        RefreshStatisticsByStop(stop);
+        return true;
+    }
+
+    bool TransportCatalogue::RemoveStop(string_view name) {
+        UpdateTimer timer(update_statistic_[static_cast<size_t>(UpdateOperation::REMOVE_STOP)]);
+        StopPtr stop = GetBusStopInfo(name);
+        if (stop == nullptr || !GetBusesByStop(name).empty()) {
+            return false;
+        }
+
+        if (auto links = busstop_distance_links_.extract(stop)) {
+            for (StopPtr other : links.mapped()) {
+                busstop_distance_info_.erase({ stop, other });
+                busstop_distance_info_.erase({ other, stop });
+                if (other == stop) {
+                    continue;
+                }
+                vector<StopPtr>& other_links = busstop_distance_links_[other];
+                other_links.erase(std::remove(other_links.begin(), other_links.end(), stop), other_links.end());
+            }
+        }
+
+        stop_index_.Erase(stop);
+        UnrankStop(stop);
+        name_index_.Erase(stop->name, NameSearchIndex::Kind::STOP);
+        ptr_busstop_route_info_.erase(stop->name);
+        ptr_busstop_info_.erase(stop->name);
+        return true;
+    }
+
+    bool TransportCatalogue::RenameStop(string_view name, string_view new_name) {
+        UpdateTimer timer(update_statistic_[static_cast<size_t>(UpdateOperation::RENAME_STOP)]);
+        StopPtr stop = GetBusStopInfo(name);
+        if (stop == nullptr || new_name.empty() || GetBusStopInfo(new_name) != nullptr) {
+            return false;
+        }
+
+        // Ключи индексов ссылаются на StopInfo::name: вынимаем узлы, меняем имя и вставляем их обратно
+        // Равные значения в рейтинге упорядочены по имени
+        UnrankStop(stop);
+        auto stop_node = ptr_busstop_info_.extract(stop->name);
+        auto buses_node = ptr_busstop_route_info_.extract(stop->name);
+        // Старое имя остаётся в хранилище, поэтому запись индекса имён ещё можно найти по нему
+        name_index_.Erase(stop->name, NameSearchIndex::Kind::STOP);
+
+        GetMutableStop(stop).name = StoreName(new_name);
+
+        stop_node.key() = stop->name;
+        ptr_busstop_info_.insert(move(stop_node));
+        if (buses_node) {
+            buses_node.key() = stop->name;
+            ptr_busstop_route_info_.insert(move(buses_node));
+        }
+        RankStop(stop);
+        name_index_.Insert({ stop->name, NameSearchIndex::Kind::STOP, GetBusesByStop(stop->name).size() });
+        return true;
+    }
+
+    const TransportCatalogue::UpdateStatistic& TransportCatalogue::GetUpdateStatistic(UpdateOperation operation) const {
+        return update_statistic_.at(static_cast<size_t>(operation));
+    }
+
+    string_view TransportCatalogue::GetUpdateOperationName(UpdateOperation operation) {
+        switch (operation) {
+        case UpdateOperation::REMOVE_BUS:
+            return "RemoveBus"sv;
+        case UpdateOperation::REPLACE_BUS:
+            return "ReplaceBus"sv;
+        case UpdateOperation::MOVE_STOP:
+            return "MoveStop"sv;
+        case UpdateOperation::REMOVE_STOP:
+            return "RemoveStop"sv;
+        case UpdateOperation::RENAME_STOP:
+            return "RenameStop"sv;
+        default:
+            return ""sv;
         }
     }
 
@@ -65,38 +449,153 @@ namespace transportcatalogue {
 
     BusStatistic TransportCatalogue::GetRouteStatistic(string_view name) const {
         BusPtr ptr = GetRouteInfo(name);
-        BusStatistic retinfo;
-
         if (ptr == nullptr) {
-            return retinfo;
+            return {};
+        }
+        return GetRouteStatistic(ptr);
+    }
+
+    BusStatistic TransportCatalogue::GetRouteStatistic(BusPtr bus) const {
+        return statistics_ready_ ? bus->statistic : ComputeRouteStatistic(bus);
+    }
+
+    bool TransportCatalogue::HasPrecomputedStatistics() const {
+        return statistics_ready_;
+    }
+
+    std::chrono::nanoseconds TransportCatalogue::PrecomputeStatistics() {
+        const auto start = std::chrono::steady_clock::now();
+        vector<BusPtr> buses;
+        buses.reserve(ptr_busroute_info_.size());
+        for (const auto& [name, bus] : ptr_busroute_info_) {
+            buses.push_back(bus);
         }
+        // Каждый кусок пишет только в записи своих автобусов, остальные данные справочника лишь читаются
+        parallel::ParallelFor(buses.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                GetMutableBus(buses[i]).statistic = ComputeRouteStatistic(buses[i]);
+            }
+            });
+        statistics_ready_ = true;
+        BuildBusRankings();
+        statistics_build_time_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        return statistics_build_time_;
+    }
+
+    std::chrono::nanoseconds TransportCatalogue::GetStatisticsBuildTime() const {
+        return statistics_build_time_;
+    }
+
+    void TransportCatalogue::RefreshStatistics(BusPtr bus) {
+        if (statistics_ready_) {
+            UnrankBus(bus);
+            GetMutableBus(bus).statistic = ComputeRouteStatistic(bus);
+            RankBus(bus);
+        }
+    }
+
+    double TransportCatalogue::GetRankingValue(const BusStatistic& statistic, BusRanking ranking) {
+        switch (ranking) {
+        case BusRanking::CURVATURE:
+            return statistic.curvature;
+        case BusRanking::ROUTE_LENGTH:
+            return statistic.distance;
+        case BusRanking::STOP_COUNT:
+            return static_cast<double>(statistic.count_stopbus);
+        default:
+            return 0.0;
+        }
+    }
+
+    void TransportCatalogue::BuildBusRankings() {
+        for (auto& ranking : bus_rankings_) {
+            ranking.Clear();
+        }
+        for (const auto& [name, bus] : ptr_busroute_info_) {
+            RankBus(bus);
+        }
+    }
+
+    void TransportCatalogue::RankBus(BusPtr bus) {
+        for (size_t i = 0; i < bus_rankings_.size(); ++i) {
+            bus_rankings_[i].Insert(bus, GetRankingValue(bus->statistic, static_cast<BusRanking>(i)));
+        }
+    }
+
+    void TransportCatalogue::UnrankBus(BusPtr bus) {
+        for (size_t i = 0; i < bus_rankings_.size(); ++i) {
+            bus_rankings_[i].Erase(bus, GetRankingValue(bus->statistic, static_cast<BusRanking>(i)));
+        }
+    }
+
+    void TransportCatalogue::BuildStopRanking() {
+        stop_ranking_.Clear();
+        for (const auto& [name, stop] : ptr_busstop_info_) {
+            stop_ranking_.Insert(stop, static_cast<double>(GetBusesByStop(name).size()));
+        }
+        stop_ranking_built_ = true;
+    }
+
+    void TransportCatalogue::RankStop(StopPtr stop) {
+        if (stop_ranking_built_) {
+            stop_ranking_.Insert(stop, static_cast<double>(GetBusesByStop(stop->name).size()));
+        }
+    }
+
+    void TransportCatalogue::UnrankStop(StopPtr stop) {
+        if (stop_ranking_built_) {
+            stop_ranking_.Erase(stop, static_cast<double>(GetBusesByStop(stop->name).size()));
+        }
+    }
+
+    vector<TransportCatalogue::RankedBus> TransportCatalogue::GetTopBuses(BusRanking ranking, size_t count) const {
+        return bus_rankings_.at(static_cast<size_t>(ranking)).GetTop(count);
+    }
+
+    vector<TransportCatalogue::RankedBus> TransportCatalogue::GetBusesInRange(BusRanking ranking, double min, double max, size_t count) const {
+        return bus_rankings_.at(static_cast<size_t>(ranking)).GetRange(min, max, count);
+    }
+
+    vector<TransportCatalogue::RankedStop> TransportCatalogue::GetTopStops(size_t count) const {
+        return stop_ranking_.GetTop(count);
+    }
 
-        set<string_view> qname;
+    vector<TransportCatalogue::RankedStop> TransportCatalogue::GetStopsInRange(double min, double max, size_t count) const {
+        return stop_ranking_.GetRange(min, max, count);
+    }
 
-        for (auto vname : ptr->busstop_info) {
-            qname.insert(vname->name);
+    void TransportCatalogue::RefreshStatisticsByStop(StopPtr stop) {
+        if (!statistics_ready_) {
+            return;
         }
+        for (BusPtr bus : GetBusesByStop(stop->name)) {
+            RefreshStatistics(bus);
+        }
+    }
+
+    BusStatistic TransportCatalogue::ComputeRouteStatistic(BusPtr ptr) const {
+        BusStatistic retinfo;
+        if (ptr->busstop_info.empty()) {
+            return retinfo;
+        }
+
+        // Указатели на остановки уникальны так же, как их имена
+        vector<StopPtr> unique_stops(ptr->busstop_info.begin(), ptr->busstop_info.end());
+        std::sort(unique_stops.begin(), unique_stops.end());
 
         retinfo.count_stopbus = ptr->busstop_info.size();
-        retinfo.uniq_stopbus = qname.size();
-        double lenghtroute = 0.0;
+        retinfo.uniq_stopbus = std::unique(unique_stops.begin(), unique_stops.end()) - unique_stops.begin();
         int distance = 0;
 
+        vector<size_t> stops_id;
+        stops_id.reserve(ptr->busstop_info.size());
+        for (StopPtr stop : ptr->busstop_info) {
+            stops_id.push_back(stop->id);
+        }
+        double lenghtroute = ComputeRouteLength(stop_vectors_, stops_id.data(), stops_id.size());
+
         for (size_t id = 0; id < ptr->busstop_info.size() - 1; ++id) {
-            lenghtroute += ComputeDistance(ptr->busstop_info[id]->coordinates, ptr->busstop_info[id + 1]->coordinates);
-            pair<string_view, string_view> bs_pair{ ptr->busstop_info[id]->name , ptr->busstop_info[id + 1]->name };
-            auto itr = busstop_distance_info_.find(bs_pair);
-            if (itr != busstop_distance_info_.end()) {
-                distance += itr->second;
-            }
-            else {
-                bs_pair.first = ptr->busstop_info[id + 1]->name;
-                bs_pair.second = ptr->busstop_info[id]->name;
-                auto itr = busstop_distance_info_.find(bs_pair);
-                if (itr != busstop_distance_info_.end()) {
-                    distance += itr->second;
-                }
-            }
+            distance += GetBusStopDistance(ptr->busstop_info[id], ptr->busstop_info[id + 1]);
         }
         retinfo.distance = distance;
         retinfo.lenght = lenghtroute;
@@ -104,32 +603,34 @@ namespace transportcatalogue {
         return retinfo;
     }
 
-    const unordered_set<string_view>& TransportCatalogue::GetRouteForBusStop(string_view name) const {
-        static const unordered_set<string_view> return_route_name{};
-        if (ptr_busstop_route_info_.count(name)) {
-            return ptr_busstop_route_info_.at(name);
-        }
-        else {
-            return return_route_name;
+    std::span<const BusPtr> TransportCatalogue::GetBusesByStop(string_view name) const {
+        auto itr = ptr_busstop_route_info_.find(name);
+        if (itr != ptr_busstop_route_info_.end()) {
+            return itr->second;
         }
+        return {};
     }
 
     int TransportCatalogue::GetBusStopDistance(std::string_view busstop, std::string_view busstop_next) const {
-        pair<string_view, string_view> bs_pair{ busstop , busstop_next };
-        auto itr = busstop_distance_info_.find(bs_pair);
+        StopPtr from = GetBusStopInfo(busstop);
+        StopPtr to = GetBusStopInfo(busstop_next);
+        if (from == nullptr || to == nullptr) {
+            return 0;
+        }
+        return GetBusStopDistance(from, to);
+    }
+
+    int TransportCatalogue::GetBusStopDistance(StopPtr busstop, StopPtr busstop_next) const {
+        auto itr = busstop_distance_info_.find({ busstop, busstop_next });
         if (itr != busstop_distance_info_.end()) {
             return itr->second;
         }
-        else {
-            bs_pair.first = busstop_next;
-            bs_pair.second = busstop;
-            auto itr = busstop_distance_info_.find(bs_pair);
-            return itr != busstop_distance_info_.end() ? itr->second : 0;
-        }
+        itr = busstop_distance_info_.find({ busstop_next, busstop });
+        return itr != busstop_distance_info_.end() ? itr->second : 0;
     }
 
     size_t TransportCatalogue::GetCountBuses() const {
-        return static_cast<int>(busroute_info_.size());
+        return ptr_busroute_info_.size();
     }
 
     const unordered_map<string_view, BusPtr>& TransportCatalogue::GetBusesInfo() const {
@@ -139,6 +640,94 @@ namespace transportcatalogue {
     const unordered_map<string_view, StopPtr>& TransportCatalogue::GetStopsInfo() const {
         return ptr_busstop_info_;
     }
-}
 
+    void TransportCatalogue::BuildIndexes() {
+        vector<StopPtr> stops;
+        stops.reserve(ptr_busstop_info_.size());
+        for (const auto& [name, ptr] : ptr_busstop_info_) {
+            stops.push_back(ptr);
+        }
+        stop_index_.Build(stops, stop_vectors_);
+        BuildNameIndex();
+        BuildStopRanking();
+    }
+
+    void TransportCatalogue::BuildNameIndex() {
+        vector<NameSearchIndex::Entry> entries;
+        entries.reserve(ptr_busstop_info_.size() + ptr_busroute_info_.size());
+        for (const auto& [name, stop] : ptr_busstop_info_) {
+            entries.push_back({ stop->name, NameSearchIndex::Kind::STOP, GetBusesByStop(name).size() });
+        }
+        vector<StopPtr> unique_stops;
+        for (const auto& [name, bus] : ptr_busroute_info_) {
+            entries.push_back({ bus->name, NameSearchIndex::Kind::BUS, CountUniqueStops(bus, unique_stops) });
+        }
+        name_index_.Build(move(entries));
+    }
 
+    vector<NameSearchIndex::Match> TransportCatalogue::SearchNamesByPrefix(string_view prefix, size_t limit) const {
+        return name_index_.FindByPrefix(prefix, limit);
+    }
+
+    vector<NameSearchIndex::Match> TransportCatalogue::SearchNamesFuzzy(string_view query, size_t max_distance, size_t limit) const {
+        return name_index_.FindFuzzy(query, max_distance, limit);
+    }
+
+    vector<StopGridIndex::StopDistance> TransportCatalogue::GetNearestStops(Coordinates point, size_t count) const {
+        return stop_index_.FindNearest(point, count);
+    }
+
+    const UnitVectors& TransportCatalogue::GetStopVectors() const {
+        return stop_vectors_;
+    }
+
+    const TransportCatalogue::StopDistances& TransportCatalogue::GetStopDistancesInfo() const {
+        return busstop_distance_info_;
+    }
+
+    void TransportCatalogue::ReportMemory(memory::MemoryReport& report, const std::string& prefix) const {
+        // Принятые буферы принадлежат и источнику, их память здесь не учитывается
+        size_t bytes = memory::HeapBytes(names_);
+        for (const string& name : names_) {
+            bytes += memory::HeapBytes(name);
+        }
+        report.Add(prefix, "names", bytes, names_.size());
+
+        report.Add(prefix, "stops", memory::HeapBytes(busstop_info_), busstop_info_.size());
+        stop_vectors_.ReportMemory(report, prefix + ".stop_vectors");
+        report.Add(prefix, "stops_by_name", memory::HeapBytes(ptr_busstop_info_), ptr_busstop_info_.size());
+
+        bytes = memory::HeapBytes(busroute_info_);
+        for (const BusInfo& bus : busroute_info_) {
+            bytes += memory::HeapBytes(bus.busstop_info);
+        }
+        report.Add(prefix, "buses", bytes, busroute_info_.size());
+        report.Add(prefix, "buses_by_name", memory::HeapBytes(ptr_busroute_info_), ptr_busroute_info_.size());
+
+        bytes = memory::HeapBytes(ptr_busstop_route_info_);
+        for (const auto& [name, buses] : ptr_busstop_route_info_) {
+            bytes += memory::HeapBytes(buses);
+        }
+        report.Add(prefix, "buses_by_stop", bytes, ptr_busstop_route_info_.size());
+
+        report.Add(prefix, "distances", memory::HeapBytes(busstop_distance_info_), busstop_distance_info_.size());
+        bytes = memory::HeapBytes(busstop_distance_links_);
+        for (const auto& [stop, links] : busstop_distance_links_) {
+            bytes += memory::HeapBytes(links);
+        }
+        report.Add(prefix, "distance_links", bytes, busstop_distance_links_.size());
+
+        stop_index_.ReportMemory(report, prefix + ".stop_grid");
+        name_index_.ReportMemory(report, prefix + ".name_search");
+    }
+
+    vector<StopGridIndex::StopDistance> TransportCatalogue::GetStopsInRadius(Coordinates point, double radius) const {
+        return stop_index_.FindInRadius(point, radius);
+    }
+
+    vector<StopPtr> TransportCatalogue::GetStopsInBox(Coordinates min, Coordinates max) const {
+        vector<StopPtr> stops = stop_index_.FindInBox(min, max);
+        std::sort(stops.begin(), stops.end(), [](StopPtr lhs, StopPtr rhs) { return lhs->name < rhs->name; });
+        return stops;
+    }
+}
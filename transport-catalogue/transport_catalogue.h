@@ -6,50 +6,207 @@
 #include <unordered_set>
 #include <set>
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <span>
 
 #include "domain.h"
+#include "stop_index.h"
+#include "name_index.h"
+#include "ranking_index.h"
 
 
 namespace transportcatalogue {
 
+	// Записи для массовой загрузки. Строки принадлежат источнику и должны жить до конца AddBatch
+	struct StopRecord {
+		string_view name;
+		Coordinates coordinates;
+	};
+
+	struct DistanceRecord {
+		string_view from;
+		string_view to;
+		int distance = 0;
+	};
+
+	struct BusRecord {
+		string_view name;
+		// Остановки как во входных данных: некольцевой маршрут разворачивается при загрузке
+		vector<string_view> stops;
+		bool is_roundtrip = false;
+	};
+
+	struct CatalogueBatch {
+		vector<StopRecord> stops;
+		vector<DistanceRecord> distances;
+		vector<BusRecord> buses;
+	};
+
 	class TransportCatalogue {
+	private:
+		// Ключ - пара указателей на остановки: хеш не зависит от имён, переименование не трогает хранилище
+		struct Distance_Hasher {
+			size_t operator()(pair<StopPtr, StopPtr> p) const noexcept {
+				size_t h1 = std::hash<StopPtr>{}(p.first);
+				size_t h2 = std::hash<StopPtr>{}(p.second);
+				return h1 * 37 + h2;
+			}
+		};
+
 	public:
-		void AddBusStop(const string& name, Coordinates coordinates);
-		void AddBusRoute(const string& name, const vector<string_view>& busroute, bool type);
+		using StopDistances = unordered_map<pair<StopPtr, StopPtr>, int, Distance_Hasher>;
+
+		enum class UpdateOperation {
+			REMOVE_BUS,
+			REPLACE_BUS,
+			MOVE_STOP,
+			REMOVE_STOP,
+			RENAME_STOP,
+			COUNT
+		};
+
+		// Показатели, по которым ранжируются автобусы
+		enum class BusRanking {
+			CURVATURE,
+			ROUTE_LENGTH,
+			STOP_COUNT,
+			COUNT
+		};
+
+		using RankedBus = RankingIndex<BusPtr>::Ranked;
+		using RankedStop = RankingIndex<StopPtr>::Ranked;
+
+		struct UpdateStatistic {
+			size_t count = 0;
+			std::chrono::nanoseconds total{ 0 };
+			std::chrono::nanoseconds last{ 0 };
+		};
+
+		TransportCatalogue() = default;
+		// Глубокое копирование: string_view и указатели пересобираются на данные копии
+		TransportCatalogue(const TransportCatalogue& other);
+		TransportCatalogue& operator=(const TransportCatalogue&) = delete;
+
+		void AddBusStop(string_view name, Coordinates coordinates);
+		void AddBusRoute(string_view name, const vector<string_view>& busroute, bool type);
 		void SetBusStopDistance(std::string_view busstop, std::string_view busstop_next, int distance);
-		
+
+		// Массовая загрузка: контейнеры резервируются один раз, разрешение имён в расстояниях и маршрутах
+		// и сортировка списков автобусов по остановкам идут параллельными кусками.
+		// Маршруты и расстояния с неизвестными остановками пропускаются.
+		void AddBatch(const CatalogueBatch& batch);
+
+		// Справочник хранит ссылку на buffer: имена новых записей, которые лежат внутри него, не копируются.
+		// Так имена из документа json::Load(std::shared_ptr) попадают в справочник без копии
+		void AdoptNameBuffer(std::shared_ptr<const string> buffer);
+
+		// Изменение загруженного справочника. Каждая операция обновляет связанные индексы
+		// за время, пропорциональное объёму изменения, и возвращает false, если изменение невозможно.
+		// Поисковый индекс имён меняется точечно, а пересобирается, только когда изменений накопилось много.
+		// Удалённые записи остаются в deque (указатели на остальные записи не меняются), но исчезают из индексов.
+		bool RemoveBus(string_view name);
+		bool ReplaceBus(string_view name, const vector<string_view>& busroute, bool type);
+		bool MoveStop(string_view name, Coordinates coordinates);
+		// Остановку, через которую проходят автобусы, удалить нельзя
+		bool RemoveStop(string_view name);
+		bool RenameStop(string_view name, string_view new_name);
+		const UpdateStatistic& GetUpdateStatistic(UpdateOperation operation) const;
+		static string_view GetUpdateOperationName(UpdateOperation operation);
+
 
 		int GetBusStopDistance(std::string_view busstop, std::string_view busstop_next) const;
+		int GetBusStopDistance(StopPtr busstop, StopPtr busstop_next) const;
 		BusPtr GetRouteInfo(string_view name) const;
 		StopPtr GetBusStopInfo(string_view name) const;
 		const unordered_map<string_view, StopPtr>& GetStopsInfo() const;
 		BusStatistic GetRouteStatistic(string_view name) const;
-		const unordered_set<string_view>& GetRouteForBusStop(string_view name) const;
+		// После PrecomputeStatistics - готовая статистика из записи автобуса, до него - расчёт на месте
+		BusStatistic GetRouteStatistic(BusPtr bus) const;
+		// Автобусы через остановку, упорядоченные по имени; список поддерживается при добавлении маршрутов
+		std::span<const BusPtr> GetBusesByStop(string_view name) const;
 		size_t GetCountBuses() const;
 		size_t GetCountStops() const;
 		const unordered_map<string_view, BusPtr>& GetBusesInfo() const;
+
+		// Построение индексов после загрузки; добавленные позже остановки попадают в индексы сразу
+		void BuildIndexes();
+		// Расчёт статистики всех автобусов параллельными кусками, возвращает время этапа
+		std::chrono::nanoseconds PrecomputeStatistics();
+		bool HasPrecomputedStatistics() const;
+
+		// Рейтинги по убыванию показателя: автобусы - после PrecomputeStatistics, остановки по числу автобусов -
+		// после BuildIndexes. Поддерживаются при изменениях справочника
+		vector<RankedBus> GetTopBuses(BusRanking ranking, size_t count) const;
+		vector<RankedBus> GetBusesInRange(BusRanking ranking, double min, double max, size_t count) const;
+		vector<RankedStop> GetTopStops(size_t count) const;
+		vector<RankedStop> GetStopsInRange(double min, double max, size_t count) const;
+		// Время последнего полного расчёта статистики
+		std::chrono::nanoseconds GetStatisticsBuildTime() const;
+		vector<StopGridIndex::StopDistance> GetNearestStops(Coordinates point, size_t count) const;
+		vector<StopPtr> GetStopsInBox(Coordinates min, Coordinates max) const;
+		vector<StopGridIndex::StopDistance> GetStopsInRadius(Coordinates point, double radius) const;
+		// Поиск остановок и автобусов по началу имени и с опечатками, без учёта регистра
+		vector<NameSearchIndex::Match> SearchNamesByPrefix(string_view prefix, size_t limit) const;
+		vector<NameSearchIndex::Match> SearchNamesFuzzy(string_view query, size_t max_distance, size_t limit) const;
+		const UnitVectors& GetStopVectors() const;
+		const StopDistances& GetStopDistancesInfo() const;
+		void ReportMemory(memory::MemoryReport& report, const std::string& prefix) const;
 		
 
 	private:
-		struct Distance_Hasher {
-			size_t operator()(pair<string_view, string_view> p) const noexcept {
-				string frt{ p.first };
-				string snd{ p.second };
-				size_t h1 = std::hash<std::string>{}(frt);
-				size_t h2 = std::hash<std::string>{}(snd);
-				return h1 * 100 + h2;
-			}
-		};
+		// Принятые буферы и собственные копии имён, на которые ссылаются StopInfo::name и BusInfo::name.
+		// Имена удалённых и переименованных записей не освобождаются, как и сами записи
+		vector<std::shared_ptr<const string>> name_buffers_;
+		deque<string> names_;
 
-	private:
 		deque<StopInfo> busstop_info_;
+		// Единичные векторы координат остановок по StopInfo::id для пакетного расчёта расстояний
+		UnitVectors stop_vectors_;
 		unordered_map<string_view, StopPtr> ptr_busstop_info_;
 
 		deque<BusInfo> busroute_info_;
 		unordered_map<string_view, BusPtr> ptr_busroute_info_;
 
-		unordered_map<string_view, unordered_set<string_view>> ptr_busstop_route_info_;
+		unordered_map<string_view, vector<BusPtr>> ptr_busstop_route_info_;
+
+		StopDistances busstop_distance_info_;
+
+		// Для каждой остановки - остановки, с которыми у неё задано расстояние в любую сторону
+		unordered_map<StopPtr, vector<StopPtr>> busstop_distance_links_;
 
-		unordered_map<pair<string_view, string_view>, int, Distance_Hasher> busstop_distance_info_;
+		StopGridIndex stop_index_;
+		NameSearchIndex name_index_;
+
+		std::array<UpdateStatistic, static_cast<size_t>(UpdateOperation::COUNT)> update_statistic_;
+
+		bool statistics_ready_ = false;
+		std::array<RankingIndex<BusPtr>, static_cast<size_t>(BusRanking::COUNT)> bus_rankings_;
+		RankingIndex<StopPtr> stop_ranking_;
+		bool stop_ranking_built_ = false;
+		std::chrono::nanoseconds statistics_build_time_{ 0 };
+
+	private:
+		// Строка с текстом name, которая живёт вместе со справочником
+		string_view StoreName(string_view name);
+		BusInfo& GetMutableBus(BusPtr bus);
+		StopInfo& GetMutableStop(StopPtr stop);
+		void LinkBusToStops(BusPtr bus);
+		void UnlinkBusFromStops(BusPtr bus);
+		void SetBusStopDistance(StopPtr from, StopPtr to, int distance);
+		BusStatistic ComputeRouteStatistic(BusPtr bus) const;
+		// Пересчёт сохранённой статистики автобусов после изменения их маршрута, остановок или расстояний
+		void RefreshStatistics(BusPtr bus);
+		void RefreshStatisticsByStop(StopPtr stop);
+		static double GetRankingValue(const BusStatistic& statistic, BusRanking ranking);
+		void BuildBusRankings();
+		void RankBus(BusPtr bus);
+		void UnrankBus(BusPtr bus);
+		void BuildStopRanking();
+		// Значение остановки в рейтинге - текущее число автобусов через неё
+		void RankStop(StopPtr stop);
+		void UnrankStop(StopPtr stop);
+		void BuildNameIndex();
 	};
 }
@@ -1,4 +1,8 @@
 #include "transport_router.h"
+#include "parallel.h"
+
+// Скорость пешехода по умолчанию, км/ч
+constexpr double DEFAULT_WALK_VELOCITY = 5.0;
 
 std::optional<RouterInfo> TransportRouter::GetGraphRoute(std::string_view route_from, std::string_view route_to) const {
 	VertexId from_vertex = vertex_.at(route_from);
@@ -9,15 +13,74 @@ std::optional<RouterInfo> TransportRouter::GetGraphRoute(std::string_view route_
 	if (!optim_route.has_value()) {
 		return std::nullopt;
 	}
+	return MakeRouterInfo(optim_route.value());
+}
+
+std::vector<RouterInfo> TransportRouter::GetGraphRoutes(std::string_view route_from, std::string_view route_to, size_t count) const {
+	VertexId from_vertex = vertex_.at(route_from);
+	VertexId to_vertex = vertex_.at(route_to);
 
+	std::vector<RouterInfo> result;
+	for (const Router<Weight>::RouteInfo& route : router_->BuildRoutes(from_vertex, to_vertex, count)) {
+		result.push_back(MakeRouterInfo(route));
+	}
+	return result;
+}
+
+RouterInfo TransportRouter::MakeRouterInfo(const Router<Weight>::RouteInfo& route) const {
 	std::vector<EdgeInfo> edges;
 	std::vector<Weight> weight;
 
-	for (size_t i = 0; i < optim_route.value().edges.size(); ++i) {
-		EdgeId id = optim_route.value().edges[i];
+	for (size_t i = 0; i < route.edges.size(); ++i) {
+		EdgeId id = route.edges[i];
 		edges.push_back(edge_info_[id]);
 		weight.push_back(graph_.GetEdge(id).weight);
 	}
+	return RouterInfo{ route.weight, std::move(edges), std::move(weight) };
+}
+
+std::optional<RouterInfo> TransportRouter::GetGraphRoute(Coordinates from, Coordinates to, size_t count) const {
+	if (!router_) {
+		return std::nullopt;
+	}
+	// Без настроек пеших переходов к остановкам идём с обычной скоростью пешехода
+	const double walk_velocity = routing_settings_.walk_velocity > 0 ? routing_settings_.walk_velocity : DEFAULT_WALK_VELOCITY;
+	const double minutes_by_meter = 0.06 / walk_velocity;
+
+	auto snap = [&](Coordinates point, std::vector<StopGridIndex::StopDistance>& stops) {
+		stops = db_.GetNearestStops(point, count);
+		std::vector<std::pair<VertexId, Weight>> vertexes;
+		vertexes.reserve(stops.size());
+		for (const auto& [stop, distance] : stops) {
+			vertexes.emplace_back(vertex_.at(stop->name), distance * minutes_by_meter);
+		}
+		return vertexes;
+	};
+	std::vector<StopGridIndex::StopDistance> from_stops;
+	std::vector<StopGridIndex::StopDistance> to_stops;
+	const auto sources = snap(from, from_stops);
+	const auto targets = snap(to, to_stops);
+
+	std::optional<Router<Weight>::MultiRouteInfo> optim_route = router_->BuildRoute(sources, targets);
+	if (!optim_route.has_value()) {
+		return std::nullopt;
+	}
+
+	const Router<Weight>::RouteInfo& route = optim_route.value().route;
+	std::vector<EdgeInfo> edges;
+	std::vector<Weight> weight;
+	edges.reserve(route.edges.size() + 2);
+	weight.reserve(route.edges.size() + 2);
+
+	edges.push_back(WalkEdgeInfo{ nullptr, from_stops[optim_route.value().source].first });
+	weight.push_back(sources[optim_route.value().source].second);
+	for (EdgeId id : route.edges) {
+		edges.push_back(edge_info_[id]);
+		weight.push_back(graph_.GetEdge(id).weight);
+	}
+	edges.push_back(WalkEdgeInfo{ to_stops[optim_route.value().target].first, nullptr });
+	weight.push_back(targets[optim_route.value().target].second);
+
 	return RouterInfo{ optim_route.value().weight, std::move(edges), std::move(weight) };
 }
 
@@ -26,6 +89,7 @@ void TransportRouter::BuildGraphRoute() {
 		graph_ = DirectedWeightedGraph<Weight>(2 * db_.GetCountStops());
 		AddAllStopVertexs(db_);
 		AddAllRouterEdges(db_);
+		AddAllWalkEdges(db_);
 		router_ = std::make_unique<Router<Weight>>(graph_);
 	}
 };
@@ -58,7 +122,7 @@ void TransportRouter::AddAllRouterEdges(const TransportCatalogue& db) {
 			for (size_t j = i + 1; j < ptr->busstop_info.size(); ++j) {
 				BusEdgeInfo bus_edge{ ptr , static_cast<int>(j - i)};
 				edge.to = vertex_[ptr->busstop_info[j]->name];
-				distance += static_cast<double>(db.GetBusStopDistance(ptr->busstop_info[j-1]->name, ptr->busstop_info[j]->name));
+				distance += static_cast<double>(db.GetBusStopDistance(ptr->busstop_info[j-1], ptr->busstop_info[j]));
 				edge.weight = distance * minutes_by_meter;
 				graph_.AddEdge(edge);
 				edge_info_.push_back(bus_edge);
@@ -70,10 +134,59 @@ void TransportRouter::AddAllRouterEdges(const TransportCatalogue& db) {
 	}
 }
 
+// Пеший переход ведёт в вершину прибытия соседней остановки, дальше - обычное ожидание автобуса.
+// Соседи ищутся по сетке остановок, поэтому этап линеен по числу остановок при ограниченной плотности.
+void TransportRouter::AddAllWalkEdges(const TransportCatalogue& db) {
+	if (routing_settings_.walk_radius <= 0 || routing_settings_.walk_velocity <= 0) {
+		return;
+	}
+	const double minutes_by_meter = 0.06 / routing_settings_.walk_velocity;
+
+	std::vector<StopPtr> stops;
+	stops.reserve(db.GetStopsInfo().size());
+	for (const auto& [stop, ptr] : db.GetStopsInfo()) {
+		stops.push_back(ptr);
+	}
+	// Поиск соседей независим для каждой остановки, рёбра добавляются в граф в исходном порядке
+	std::vector<std::vector<StopGridIndex::StopDistance>> neighbours(stops.size());
+	parallel::ParallelFor(stops.size(), 256, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			neighbours[i] = db.GetStopsInRadius(stops[i]->coordinates, routing_settings_.walk_radius);
+		}
+		});
+
+	Edge edge{ 0 , 0 , 0.0 };
+	for (size_t i = 0; i < stops.size(); ++i) {
+		edge.from = vertex_[stops[i]->name];
+		for (const auto& [stop, distance] : neighbours[i]) {
+			if (stop == stops[i]) {
+				continue;
+			}
+			edge.to = vertex_[stop->name];
+			edge.weight = distance * minutes_by_meter;
+			graph_.AddEdge(edge);
+			edge_info_.push_back(WalkEdgeInfo{ stops[i], stop });
+		}
+	}
+}
+
 const RoutingSettings& TransportRouter::GetRoutingSettings() const {
 	return routing_settings_;
 }
 
+void TransportRouter::ReportMemory(memory::MemoryReport& report, const std::string& prefix) const {
+	graph_.ReportMemory(report, prefix + ".graph");
+	report.Add(prefix, "vertex_by_stop", memory::HeapBytes(vertex_), vertex_.size());
+	report.Add(prefix, "edge_info", memory::HeapBytes(edge_info_), edge_info_.size());
+	if (router_) {
+		router_->ReportMemory(report, prefix + ".router");
+	}
+}
+
 void TransportRouter::SetRoutingSettings(int wait, int velocity) {
 	routing_settings_.SetParams(wait, velocity);
+}
+
+void TransportRouter::SetWalkSettings(double radius, double velocity) {
+	routing_settings_.SetWalkParams(radius, velocity);
 }
\ No newline at end of file
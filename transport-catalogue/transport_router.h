@@ -20,7 +20,13 @@ struct WaitEdgeInfo {
 	VertexId id;
 };
 
-using EdgeInfo = std::variant<BusEdgeInfo, WaitEdgeInfo>;
+// Для маршрута между точками первый и последний переходы ведут из точки и в точку: from или to равен nullptr
+struct WalkEdgeInfo {
+	StopPtr from;
+	StopPtr to;
+};
+
+using EdgeInfo = std::variant<BusEdgeInfo, WaitEdgeInfo, WalkEdgeInfo>;
 
 struct RouterInfo {
 	Weight weight;
@@ -34,12 +40,21 @@ public:
 
 	void BuildGraphRoute();
 	std::optional<RouterInfo> GetGraphRoute(std::string_view, std::string_view) const;
+	// До count маршрутов без циклов по возрастанию времени, первый - оптимальный
+	std::vector<RouterInfo> GetGraphRoutes(std::string_view, std::string_view, size_t count) const;
+	// Маршрут между произвольными точками: каждый конец привязывается к count ближайшим остановкам
+	// с пешим переходом, лучшая пара остановок выбирается за один проход по таблице маршрутизатора
+	std::optional<RouterInfo> GetGraphRoute(Coordinates from, Coordinates to, size_t count) const;
 	const RoutingSettings& GetRoutingSettings() const;
 	void SetRoutingSettings(int wait, int velocity);
+	void SetWalkSettings(double radius, double velocity);
+	void ReportMemory(memory::MemoryReport& report, const std::string& prefix) const;
 
 private:
 	void AddAllStopVertexs(const TransportCatalogue& db);
 	void AddAllRouterEdges(const TransportCatalogue& db);
+	void AddAllWalkEdges(const TransportCatalogue& db);
+	RouterInfo MakeRouterInfo(const Router<Weight>::RouteInfo& route) const;
 private:
 	const TransportCatalogue& db_;
 	RoutingSettings routing_settings_;